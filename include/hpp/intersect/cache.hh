@@ -0,0 +1,134 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#ifndef HPP_INTERSECT_CACHE_HH
+#define HPP_INTERSECT_CACHE_HH
+
+#include <hpp/intersect/intersect.hh>
+#include <hpp/intersect/polytope.hh>
+
+namespace hpp {
+    namespace intersect {
+
+    /// \addtogroup intersect
+    /// \{
+
+        /// Cache of the triangles and inequalities of triangle models.
+        /// The data are expressed in the model frame: they do not depend on any pose
+        /// and are computed once per model, on first use. Entries are identified by
+        /// the model, which is kept alive by the cache until clear () is called.
+        /// A model only holds the data that were asked for, e.g. its welded mesh and
+        /// polytope with intersect::CONVEX_CLIPPING. For pairs of models found not in contact,
+        /// a plane separating them is kept to reject the next queries on the pair.
+        /// A cache is not thread safe: use one instance per thread.
+        class MeshCache
+        {
+        public:
+          /// Return the welded mesh of a model, see intersect::weldMesh. Vertices closer
+          /// than 1e-9 are welded.
+          /// \param model triangle model shared by one or several objects.
+          const WeldedMesh& modelMesh (const BVHModelOBConst_Ptr_t& model);
+
+          /// Return the triangles of a model in its own frame, in the order of
+          /// the model triangles, with the vertices of the welded mesh of the model.
+          /// \param model triangle model shared by one or several objects.
+          const std::vector<TrianglePoints>& modelTriangles (const BVHModelOBConst_Ptr_t& model);
+
+          /// Return the planes of the triangles of a model in its own frame, which
+          /// are the inequalities of the model if it is convex,
+          /// see intersect::fcl2inequalities.
+          /// \param model triangle model shared by one or several objects.
+          const Inequality& modelInequality (const BVHModelOBConst_Ptr_t& model);
+
+          /// Return the convex hull of a model in its own frame compiled for inside tests,
+          /// see intersect::Polytope. The inequalities of the hull, see
+          /// intersect::convexHullInequalities, are not kept.
+          /// \param model triangle model shared by one or several objects.
+          const Polytope& modelPolytope (const BVHModelOBConst_Ptr_t& model);
+
+          /// Return true if the plane kept for a pair of models still separates the
+          /// vertices of the rom model from those of the affordance model placed at a
+          /// pose in the rom model frame: the models are then not in contact. The plane
+          /// is tested against the bounding sphere of the affordance model first, then
+          /// against its vertices. A plane that no longer separates the models is dropped.
+          /// \param romModel, affModel models of the rom and of the affordance.
+          /// \param R, T rotation and translation of the affordance in the rom model frame.
+          bool separated (const BVHModelOBConst_Ptr_t& romModel,
+                  const BVHModelOBConst_Ptr_t& affModel, const fcl::Matrix3f& R,
+                  const fcl::Vec3f& T);
+
+          /// Look for a plane separating the vertices of two models found not in contact,
+          /// and keep it for the next queries on the pair, see separated. The planes of
+          /// the rom hull and the plane orthogonal to the line between the centers of the
+          /// models are tried. Returns false if none of them separates the models.
+          /// \param romModel, affModel models of the rom and of the affordance.
+          /// \param R, T rotation and translation of the affordance in the rom model frame.
+          bool findSeparation (const BVHModelOBConst_Ptr_t& romModel,
+                  const BVHModelOBConst_Ptr_t& affModel, const fcl::Matrix3f& R,
+                  const fcl::Vec3f& T);
+
+          /// Remove all entries and release the models held by the cache.
+          void clear ();
+
+        private:
+          // model frame data of a model
+          struct ModelEntry
+          {
+            ModelEntry (): hasTriangles_ (false),
+                    inequality_ (Eigen::MatrixXd (), Eigen::VectorXd (),
+                        Eigen::MatrixXd (), Eigen::MatrixXd ()),
+                    hasInequality_ (false),
+                    hasPolytope_ (false)
+            {}
+            // model is kept to guarantee the key stays unique
+            BVHModelOBConst_Ptr_t model_;
+            WeldedMesh mesh_;
+            std::vector<TrianglePoints> triangles_;
+            bool hasTriangles_;
+            // planes of the triangles
+            Inequality inequality_;
+            bool hasInequality_;
+            Polytope polytope_;
+            bool hasPolytope_;
+          };
+          // plane normal_.x = support_ in the rom model frame: the rom vertices are on
+          // the side normal_.x <= support_, the affordance vertices strictly on the other
+          struct Witness
+          {
+            Eigen::Vector3d normal_;
+            double support_;
+          };
+          typedef std::pair<const BVHModelOB*, const BVHModelOB*> PairKey_t;
+
+          /// Return the model frame entry of a model, whose welded mesh is computed
+          /// on first use.
+          ModelEntry& modelEntry (const BVHModelOBConst_Ptr_t& model);
+
+          std::map<const BVHModelOB*, ModelEntry> models_;
+          // separating planes of (rom, affordance) model pairs, whose models are kept
+          // alive by their model frame entries
+          std::map<PairKey_t, Witness> witnesses_;
+        };
+
+    /// \}
+
+    } // namespace intersect
+} // namespace hpp
+
+#endif // HPP_INTERSECT_CACHE_HH
@@ -35,6 +35,11 @@ namespace hpp {
           typedef std::pair <fcl::CollisionObjectPtr_t, fcl::CollisionObjectPtr_t>
               CollisionPair_t;
 
+          class MeshCache;
+          class IntersectionWorkspace;
+          class ResultCache;
+          class QueryContext;
+
       } // namespace intersect
 } // namespace hpp
 
@@ -7,6 +7,7 @@
 #include <Eigen/Dense>
 #include <Eigen/src/Core/util/Macros.h>
 #include <vector>
+#include <algorithm>
 
 namespace geom
 {
@@ -22,6 +23,31 @@ namespace geom
              typename CPointRef= const Eigen::Ref<const Point>&, typename In>
     T convexHull(In pointsBegin, In pointsEnd);
 
+    /// Same as above, but the hull is written to res, whose previous content is discarded.
+    /// Lets the caller reuse the storage of res across calls.
+    template<typename T, int Dim=3, typename Numeric=double, typename Point=Eigen::Matrix<Numeric, Dim, 1>,
+             typename CPointRef= const Eigen::Ref<const Point>&, typename In>
+    void convexHull(In pointsBegin, In pointsEnd, T& res);
+
+    /// Implementation of the monotone chain algorithm (A. M. Andrew, 1979) to determine the
+    /// 2D projection of the convex hull of a set of points, in O(n log n).
+    /// Same interface and output as convexHull: clockwise traversal of the hull, starting
+    /// from the point with lowest x (then lowest y), first point included twice.
+    /// Points that coincide in the projection plane are kept once, and points lying on an
+    /// edge of the hull are not hull vertices, so that the result only depends on the set of points.
+    ///
+    /// \param pointsBegin, pointsEnd iterators to first and last points of a set
+    /// \return clockwise traversal of the 2D convex hull of the points
+    template<typename T, int Dim=3, typename Numeric=double, typename Point=Eigen::Matrix<Numeric, Dim, 1>,
+             typename CPointRef= const Eigen::Ref<const Point>&, typename In>
+    T monotoneChainHull(In pointsBegin, In pointsEnd);
+
+    /// Same as above, but the hull is written to res, whose previous content is discarded.
+    /// res is also used as working storage: its capacity grows to three times the number of points.
+    template<typename T, int Dim=3, typename Numeric=double, typename Point=Eigen::Matrix<Numeric, Dim, 1>,
+             typename CPointRef= const Eigen::Ref<const Point>&, typename In>
+    void monotoneChainHull(In pointsBegin, In pointsEnd, T& res);
+
     /// Test whether a 2d point belongs to a 2d convex hull
     /// source http://softsurfer.com/Archive/algorithm_0103/algorithm_0103.htm#wn_PinPolygon()
     ///
@@ -66,7 +92,8 @@ namespace geom
              typename CPointRef= const Eigen::Ref<const Point>& >
     Numeric isLeft(CPointRef lA, CPointRef lB, CPointRef p2);
 
-    /// leftMost(): returns the point most "on the left" for a given set
+    /// leftMost(): returns the point most "on the left" for a given set,
+    /// the lowest one among points with the same x
     /// \param pointsBegin, pointsEnd iterators to first and last points of a set
     template<int Dim=3, typename Numeric=double, typename Point=Eigen::Matrix<Numeric, Dim, 1>, typename In >
     In leftMost(In pointsBegin, In pointsEnd);
@@ -93,7 +120,9 @@ namespace geom
         In current = pointsBegin +1;In res = pointsBegin;
         while(current!= pointsEnd)
         {
-            if(current->operator[](0) < res->operator[](0))
+            if(current->operator[](0) < res->operator[](0) ||
+               (current->operator[](0) == res->operator[](0) &&
+                current->operator[](1) < res->operator[](1)))
                 res = current;
             ++current;
         }
@@ -105,22 +134,102 @@ namespace geom
     T convexHull(In pointsBegin, In pointsEnd)
     {
         T res;
+        convexHull<T, Dim, Numeric, Point, CPointRef, In>(pointsBegin, pointsEnd, res);
+        return res;
+    }
+
+    template<typename T, int Dim=3, typename Numeric=double, typename Point=Eigen::Matrix<Numeric, Dim, 1>,
+             typename CPointRef= const Eigen::Ref<const Point>&, typename In>
+    void convexHull(In pointsBegin, In pointsEnd, T& res)
+    {
+        res.clear();
+        // a hull has at most as many vertices as there are points: bounds the loop
+        // should rounding errors prevent it from coming back to the first point
+        const long nPoints = (long) std::distance(pointsBegin, pointsEnd);
         Point pointOnHull = *leftMost(pointsBegin, pointsEnd);
         Point lastPoint = *pointsBegin;
         do {
             lastPoint = *pointsBegin;
             for(In current = pointsBegin +1; current!= pointsEnd; ++current)
             {
-                if((lastPoint == pointOnHull) || (isLeft(pointOnHull, lastPoint,*current) > 0))
+                Numeric turn = isLeft(pointOnHull, lastPoint,*current);
+                // among collinear candidates the farthest one is the next hull vertex
+                if((lastPoint == pointOnHull) || (turn > 0) ||
+                   (turn == 0 && dot<const Point&>(*current - pointOnHull, *current - pointOnHull) >
+                                 dot<const Point&>(lastPoint - pointOnHull, lastPoint - pointOnHull)))
                     lastPoint = *current;
             }
             res.insert(res.end(),pointOnHull);
             pointOnHull = lastPoint;
-        } while(lastPoint != *res.begin());
-        res.insert(res.end(), lastPoint);
+        } while(lastPoint != *res.begin() && (long) res.size() < nPoints);
+        res.insert(res.end(), *res.begin());
+    }
+
+    /// lexicographicLess(): orders points by x, then y, then z
+    template<int Dim, typename CPointRef>
+    bool lexicographicLess(CPointRef a, CPointRef b)
+    {
+        for(int i = 0; i < Dim; ++i)
+        {
+            if(a[i] != b[i])
+                return a[i] < b[i];
+        }
+        return false;
+    }
+
+    /// sameProjection(): tests whether two points coincide exactly in the z = 0 plane
+    template<typename CPointRef>
+    bool sameProjection(CPointRef a, CPointRef b)
+    {
+        return a[0] == b[0] && a[1] == b[1];
+    }
+
+    template<typename T, int Dim=3, typename Numeric=double, typename Point=Eigen::Matrix<Numeric, Dim, 1>,
+             typename CPointRef= const Eigen::Ref<const Point>&, typename In>
+    T monotoneChainHull(In pointsBegin, In pointsEnd)
+    {
+        T res;
+        monotoneChainHull<T, Dim, Numeric, Point, CPointRef, In>(pointsBegin, pointsEnd, res);
         return res;
     }
 
+    template<typename T, int Dim=3, typename Numeric=double, typename Point=Eigen::Matrix<Numeric, Dim, 1>,
+             typename CPointRef= const Eigen::Ref<const Point>&, typename In>
+    void monotoneChainHull(In pointsBegin, In pointsEnd, T& res)
+    {
+        // sorted points are kept at the front of res, the hull is built behind them
+        res.assign(pointsBegin, pointsEnd);
+        if(res.empty())
+            return;
+        std::sort(res.begin(), res.end(), lexicographicLess<Dim, const Point&>);
+        res.erase(std::unique(res.begin(), res.end(), sameProjection<const Point&>), res.end());
+        const std::size_t n = res.size();
+        if(n == 1)
+        {
+            res.push_back(res.front());
+            return;
+        }
+        res.reserve(3 * n);
+        // upper chain from left to right, then lower chain from right to left: only
+        // right turns are kept, collinear points are dropped
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            while(res.size() >= n + 2 && isLeft<Dim, Numeric, Point, const Point&>
+                  (res[res.size() - 2], res[res.size() - 1], res[i]) >= 0)
+                res.pop_back();
+            res.push_back(res[i]);
+        }
+        const std::size_t upperEnd = res.size();
+        for(std::size_t i = n - 1; i-- > 0;)
+        {
+            while(res.size() > upperEnd && isLeft<Dim, Numeric, Point, const Point&>
+                  (res[res.size() - 2], res[res.size() - 1], res[i]) >= 0)
+                res.pop_back();
+            res.push_back(res[i]);
+        }
+        res.erase(res.begin(), res.begin() + n);
+    }
+
     template<int Dim=3, typename Numeric=double, typename Point=Eigen::Matrix<Numeric, Dim, 1>,
              typename Point2=Eigen::Matrix<Numeric, 2, 1>,
              typename CPointRef= const Eigen::Ref<const Point>&, typename In>
@@ -21,6 +21,7 @@
 #define HPP_INTERSECT_INTERSECT_HH
 
 #include <hpp/intersect/fwd.hh>
+#include <hpp/fcl/math/transform.h>
 
 namespace hpp {
     namespace intersect {
@@ -28,6 +29,12 @@ namespace hpp {
     /// \addtogroup intersect
     /// \{
        
+        /// helper class to save triangle vertex positions in world frame
+        struct TrianglePoints
+        {
+            fcl::Vec3f p1, p2, p3;
+        };
+
         /// helper class for stacked inequalities.
         struct Inequality
         {
@@ -40,6 +47,75 @@ namespace hpp {
           Eigen::MatrixXd V_;
         };
 
+        /// Indexed representation of a triangle model in which the duplicate vertices
+        /// of the model are welded, see intersect::weldMesh.
+        struct WeldedMesh
+        {
+          /// unique vertices of the model triangles, in the model frame
+          std::vector<Eigen::Vector3d> vertices_;
+          /// indices in vertices_ of the corners of model triangle k are
+          /// indices_[3*k], indices_[3*k+1] and indices_[3*k+2]
+          std::vector<int> indices_;
+          /// true for the model triangles of zero area, which are skipped by
+          /// the intersection tests
+          std::vector<bool> degenerate_;
+          /// corners of the axis aligned box around vertices_, in the model frame
+          Eigen::Vector3d min_, max_;
+          /// sphere around vertices_ centered on the box, in the model frame;
+          /// the radius is negative if the mesh has no vertex
+          Eigen::Vector3d center_;
+          double radius_;
+        };
+
+        /// Strategy used to select the triangle pairs that are passed to the
+        /// exact triangle-triangle intersection test in getIntersectionPoints,
+        /// or to replace that test for convex roms.
+        enum PairSelection
+        {
+          /// descend the OBBRSS hierarchies of both models and test the leaf
+          /// pairs with overlapping bounding volumes.
+          BVH_TRAVERSAL,
+          /// ask fcl::collide for all contacts and only test the triangle pairs
+          /// (fcl::Contact::b1, fcl::Contact::b2) reported by fcl.
+          FCL_CONTACTS,
+          /// the rom is assumed to be convex: each affordance triangle is clipped
+          /// against the planes of the rom inequalities (see intersect::clipTriangle),
+          /// no triangle pair is tested. The contact points are the vertices of the
+          /// clipped polygons.
+          CONVEX_CLIPPING
+        };
+
+        /// Parameters of the contact region computation in getIntersectionPoints.
+        struct IntersectionRequest
+        {
+          IntersectionRequest (const PairSelection pairSelection = BVH_TRAVERSAL,
+                   const unsigned int numThreads = 1,
+                   const std::size_t parallelThreshold = 2000,
+                   const double mergeTolerance = 1e-6,
+                   const double maxRegionSpacing = 0.,
+                   const std::size_t maxRegionPoints = 0):
+                   pairSelection_ (pairSelection), numThreads_ (numThreads),
+                   parallelThreshold_ (parallelThreshold), mergeTolerance_ (mergeTolerance),
+                   maxRegionSpacing_ (maxRegionSpacing), maxRegionPoints_ (maxRegionPoints) {}
+          PairSelection pairSelection_;
+          /// number of threads used by one query; 1 runs the query on the calling
+          /// thread only, 0 uses all hardware threads.
+          unsigned int numThreads_;
+          /// minimum number of affordance triangles for a query to run in parallel.
+          std::size_t parallelThreshold_;
+          /// contact points closer than this distance are merged before the convex hull
+          /// is computed; 0 keeps all points.
+          double mergeTolerance_;
+          /// maximum distance between two consecutive points of the contact region
+          /// along the convex hull; if <= 0, the length of the shortest hull edge
+          /// longer than 1 cm is used, and at most 10 cm.
+          double maxRegionSpacing_;
+          /// maximum number of points of the contact region, 0 for no limit. Bounds
+          /// the cost of fitting a shape to the region; the hull vertices enclosing
+          /// the largest area are kept first.
+          std::size_t maxRegionPoints_;
+        };
+
         /// Compute radius and rotation of an elliptic or circular shape
         /// from given vector of parameters of the conic function.
         /// Rotation \param tau is given for an ellipse as the angle of its
@@ -75,15 +151,112 @@ namespace hpp {
 
         /// Create a set of inequalities based on a fcl::CollisionObject. The
         /// returned matrices may be used to find out whether a point is within
-        /// the collision object. Returns the inequality matrices as one object (intersect::Inequality).
+        /// the convex hull of the collision object, see intersect::convexHullInequalities.
+        /// Returns the inequality matrices as one object (intersect::Inequality).
+        /// There is one row per facet of the hull, with unit normals, and not one row per
+        /// triangle of the object: use fcl2inequalities (triangles) with the world frame
+        /// triangles (see intersect::getWorldTriangles) for the planes of the triangles.
+        /// The inequalities are expressed in world frame and must be rebuilt when the
+        /// object moves; see intersect::fcl2polytope for a hull reused across poses.
         /// \param rom fcl:CollisionObject that will be used to create inequalities.
         Inequality fcl2inequalities (const fcl::CollisionObjectPtr_t& rom);
 
+        /// Create the minimal set of inequalities of the convex hull of a set of triangles.
+        /// The hull is computed with the quickhull algorithm and coplanar triangles of
+        /// the hull are merged, so that there is one row per facet; rows of
+        /// Inequality::A_ are unit normals. Concavities of the mesh are ignored.
+        /// If the vertices of the triangles do not span a volume, one row per triangle is
+        /// returned as by fcl2inequalities (triangles). Throws std::runtime_error if no
+        /// consistent hull could be built from the vertices.
+        /// \param triangles triangles whose vertices are used to create inequalities.
+        /// \param ineq inequalities of the convex hull of the triangles.
+        void convexHullInequalities (const std::vector<TrianglePoints>& triangles, Inequality& ineq);
+
+        /// Same as above for the triangles of a welded mesh, in its model frame. The hull
+        /// is built on the unique vertices of the mesh.
+        /// \param mesh welded mesh, see intersect::weldMesh.
+        /// \param ineq inequalities of the convex hull of the mesh.
+        void convexHullInequalities (const WeldedMesh& mesh, Inequality& ineq);
+
+        /// Create a set of inequalities from triangles already expressed in world frame.
+        /// Row k of Inequality::A_ and Inequality::b_ is the plane of triangle k, so that
+        /// the result also serves as the store of triangle planes used by the
+        /// triangle intersection test, for convex and non convex meshes alike.
+        /// \param triangles triangles of the convex object that will be used to create inequalities.
+        Inequality fcl2inequalities (const std::vector<TrianglePoints>& triangles);
+
+        /// Same as above, the inequalities are written to ineq. The storage of ineq is
+        /// reused if the number of triangles did not change since it was last filled.
+        /// \param triangles triangles of the convex object that will be used to create inequalities.
+        /// \param ineq inequalities of the object.
+        void fcl2inequalities (const std::vector<TrianglePoints>& triangles, Inequality& ineq);
+
+        /// Return the underlying triangle model of a fcl::CollisionObject. The object
+        /// is expected to hold a BVHModel with OBBRSS bounding volumes.
+        /// \param object fcl::CollisionObject whose model is returned.
+        BVHModelOBConst_Ptr_t GetModel (const fcl::CollisionObjectConstPtr_t& object);
+
+        /// Compute the position of the vertices of all triangles of a model placed
+        /// at a given pose, in the order of the model triangles.
+        /// \param model triangle model whose triangles are transformed.
+        /// \param tf pose of the model in the frame of the returned triangles.
+        /// \param triangles vector filled with the transformed triangles.
+        void getTriangles (const BVHModelOB& model, const fcl::Transform3f& tf,
+                std::vector<TrianglePoints>& triangles);
+
+        /// Weld the vertices of a triangle model: vertices closer than tolerance are
+        /// replaced by the first of them, and only the vertices of the triangles are
+        /// kept. Triangles with two welded corners or whose height is below tolerance
+        /// are marked degenerate. The triangles keep their model indices. The bounds
+        /// of the mesh are computed from its vertices, not read from the model.
+        /// \param model triangle model to weld.
+        /// \param tolerance distance under which two vertices are welded.
+        /// \param mesh indexed representation of the model, replaced.
+        void weldMesh (const BVHModelOB& model, const double tolerance, WeldedMesh& mesh);
+
+        /// Compute the position of the vertices of all triangles of a welded mesh placed
+        /// at a given pose, in the order of the model triangles. Each unique vertex is
+        /// transformed once.
+        /// \param mesh welded mesh whose triangles are transformed.
+        /// \param tf pose of the mesh in the frame of the returned triangles.
+        /// \param vertices vector filled with the transformed vertices of the mesh.
+        /// \param triangles vector filled with the transformed triangles.
+        void getTriangles (const WeldedMesh& mesh, const fcl::Transform3f& tf,
+                std::vector<Eigen::Vector3d>& vertices, std::vector<TrianglePoints>& triangles);
+
+        /// Compute the world frame position of the vertices of all triangles of
+        /// a fcl::CollisionObject, in the order of the model triangles.
+        /// \param object fcl::CollisionObject whose triangles are transformed.
+        /// \param triangles vector filled with the transformed triangles.
+        void getWorldTriangles (const fcl::CollisionObjectPtr_t& object,
+                std::vector<TrianglePoints>& triangles);
+
         /// Return true if a point is inside a set of planes described by intersect::Inequality.
         /// \param ineq object comprising the planes that form inequalities.
         /// \param point point to be tested against the inequalities.
         bool is_inside (const Inequality& ineq, const Eigen::Vector3d point);
 
+        /// Test many points at once against a set of inequalities described by
+        /// intersect::Inequality. Planes are tested in blocks, and the points found
+        /// outside the planes of a block are dropped before the next block is tested.
+        /// \param ineq object comprising the planes that form inequalities.
+        /// \param points points to be tested, one per column.
+        /// \param inside filled with the increasing indices of the columns of points
+        ///        that are inside the planes.
+        void is_inside (const Inequality& ineq, const Eigen::Matrix3Xd& points,
+                std::vector<std::size_t>& inside);
+
+        /// Clip a triangle against the planes of a set of inequalities (Sutherland-Hodgman).
+        /// If the inequalities describe a convex object, the result is the part of the
+        /// triangle inside the object. Returns false, with an empty polygon, as soon as
+        /// the triangle is found entirely outside one of the planes.
+        /// \param ineq object comprising the planes that form inequalities.
+        /// \param triangle triangle to be clipped.
+        /// \param polygon vertices of the clipped polygon, in the order of the triangle.
+        /// \param buffer storage used during clipping, reused across calls.
+        bool clipTriangle (const Inequality& ineq, const TrianglePoints& triangle,
+                std::vector<Eigen::Vector3d>& polygon, std::vector<Eigen::Vector3d>& buffer);
+
         /// Get contact points resulting from collision between two fcl::CollisionObjects.
         /// Uses the fcl::collision function to verify collision but for the contact point
         /// computation, a self-implemented triangle-intersection algorithm based on that of
@@ -92,8 +265,108 @@ namespace hpp {
         /// the rom object are also considered contact points if they form part of the convex hull.
         /// \param rom fcl::CollisionObject that presents the reachability of a robot limb.
         /// \param affordance fcl::CollisionObject presenting the contact surface in collision with a limb.
+        /// \param request parameters of the computation, see intersect::IntersectionRequest.
+        std::vector<Eigen::Vector3d> getIntersectionPoints (const fcl::CollisionObjectPtr_t& rom,
+               const fcl::CollisionObjectPtr_t& affordance,
+               const IntersectionRequest& request = IntersectionRequest ());
+
+        /// Get contact points resulting from collision between two fcl::CollisionObjects.
+        /// Same as above, but the model frame triangles and inequalities of both
+        /// objects are taken from a intersect::MeshCache and kept across queries.
+        /// The computation is done in the model frame of the object with more
+        /// triangles: only the vertices of the other one are transformed.
+        /// \param rom fcl::CollisionObject that presents the reachability of a robot limb.
+        /// \param affordance fcl::CollisionObject presenting the contact surface in collision with a limb.
+        /// \param cache cache of model frame data kept by the caller across queries.
+        /// \param request parameters of the computation, see intersect::IntersectionRequest.
+        std::vector<Eigen::Vector3d> getIntersectionPoints (const fcl::CollisionObjectPtr_t& rom,
+               const fcl::CollisionObjectPtr_t& affordance, MeshCache& cache,
+               const IntersectionRequest& request = IntersectionRequest ());
+
+        /// Get contact points resulting from collision between two fcl::CollisionObjects.
+        /// Same as above, but all intermediate results are kept in the buffers of a
+        /// intersect::IntersectionWorkspace reused across queries. Once the buffers have
+        /// grown to the size of the queries, a query running on one thread does no
+        /// heap allocation in intersect itself.
+        /// \param rom fcl::CollisionObject that presents the reachability of a robot limb.
+        /// \param affordance fcl::CollisionObject presenting the contact surface in collision with a limb.
+        /// \param cache cache of model frame data kept by the caller across queries.
+        /// \param workspace scratch buffers kept by the caller across queries.
+        /// \param request parameters of the computation, see intersect::IntersectionRequest.
+        /// \return the contact region, stored in workspace and valid until its next use.
+        const std::vector<Eigen::Vector3d>& getIntersectionPoints (const fcl::CollisionObjectPtr_t& rom,
+               const fcl::CollisionObjectPtr_t& affordance, MeshCache& cache,
+               IntersectionWorkspace& workspace,
+               const IntersectionRequest& request = IntersectionRequest ());
+
+        /// Get contact points resulting from collision between two fcl::CollisionObjects.
+        /// Same as above, for successive queries of a rom moving along a trajectory: the
+        /// candidate triangle pairs of a query are kept in a intersect::QueryContext and
+        /// tested again by the next queries as long as the rom has moved little, so that
+        /// the cost of a step depends on the size of the contact rather than on the meshes.
+        /// \param rom fcl::CollisionObject that presents the reachability of a robot limb.
+        /// \param affordance fcl::CollisionObject presenting the contact surface in collision with a limb.
+        /// \param cache cache of model frame data kept by the caller across queries.
+        /// \param workspace scratch buffers kept by the caller across queries.
+        /// \param context candidate pairs kept between the queries of a trajectory.
+        /// \param request parameters of the computation, see intersect::IntersectionRequest.
+        /// \return the contact region, stored in workspace and valid until its next use.
+        const std::vector<Eigen::Vector3d>& getIntersectionPoints (const fcl::CollisionObjectPtr_t& rom,
+               const fcl::CollisionObjectPtr_t& affordance, MeshCache& cache,
+               IntersectionWorkspace& workspace, QueryContext& context,
+               const IntersectionRequest& request = IntersectionRequest ());
+
+        /// Get contact points resulting from collision between two fcl::CollisionObjects.
+        /// Same as above, but the region is first looked up in a intersect::ResultCache,
+        /// which may be shared by several threads, and stored in it when it is computed.
+        /// Objects whose bounds are disjoint are rejected before the lookup.
+        /// \param rom fcl::CollisionObject that presents the reachability of a robot limb.
+        /// \param affordance fcl::CollisionObject presenting the contact surface in collision with a limb.
+        /// \param cache cache of model frame data kept by the caller across queries.
+        /// \param workspace scratch buffers kept by the caller across queries.
+        /// \param results regions of previous queries, for the parameters of request.
+        /// \param request parameters of the computation, see intersect::IntersectionRequest.
         std::vector<Eigen::Vector3d> getIntersectionPoints (const fcl::CollisionObjectPtr_t& rom,
-               const fcl::CollisionObjectPtr_t& affordance);
+               const fcl::CollisionObjectPtr_t& affordance, MeshCache& cache,
+               IntersectionWorkspace& workspace, ResultCache& results,
+               const IntersectionRequest& request = IntersectionRequest ());
+
+        /// Get the contact regions between one rom and several affordance objects.
+        /// The model frame data of the rom are prepared once for all affordances, and
+        /// affordances whose bounding volume does not overlap the rom are skipped.
+        /// Returns one contact region per affordance, in the order of affordances;
+        /// regions of affordances not in contact with the rom are empty.
+        /// \param rom fcl::CollisionObject that presents the reachability of a robot limb.
+        /// \param affordances fcl::CollisionObjects presenting candidate contact surfaces.
+        /// \param request parameters of the computation, see intersect::IntersectionRequest.
+        std::vector<std::vector<Eigen::Vector3d> > getIntersectionPoints
+            (const fcl::CollisionObjectPtr_t& rom,
+             const std::vector<fcl::CollisionObjectPtr_t>& affordances,
+             const IntersectionRequest& request = IntersectionRequest ());
+
+        /// Same as above, with model frame data kept in a intersect::MeshCache across queries.
+        /// \param rom fcl::CollisionObject that presents the reachability of a robot limb.
+        /// \param affordances fcl::CollisionObjects presenting candidate contact surfaces.
+        /// \param cache cache of model frame data kept by the caller across queries.
+        /// \param request parameters of the computation, see intersect::IntersectionRequest.
+        std::vector<std::vector<Eigen::Vector3d> > getIntersectionPoints
+            (const fcl::CollisionObjectPtr_t& rom,
+             const std::vector<fcl::CollisionObjectPtr_t>& affordances, MeshCache& cache,
+             const IntersectionRequest& request = IntersectionRequest ());
+
+        /// Get the contact regions between one affordance object and a rom model placed
+        /// at several poses. The triangles and inequalities of both models are prepared
+        /// once in their model frame; for each pose only the vertices of the smaller mesh
+        /// are moved into the model frame of the other one. Returns one contact region per pose, in world frame and
+        /// in the order of romPoses; regions of poses not in contact are empty.
+        /// \param romModel model presenting the reachability of a robot limb.
+        /// \param romPoses poses of the rom model in world frame.
+        /// \param affordance fcl::CollisionObject presenting the contact surface.
+        /// \param request parameters of the computation, see intersect::IntersectionRequest.
+        std::vector<std::vector<Eigen::Vector3d> > getIntersectionPoints
+            (const BVHModelOBConst_Ptr_t& romModel, const std::vector<fcl::Transform3f>& romPoses,
+             const fcl::CollisionObjectPtr_t& affordance,
+             const IntersectionRequest& request = IntersectionRequest ());
 
     /// \}
     
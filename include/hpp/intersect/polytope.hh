@@ -0,0 +1,139 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#ifndef HPP_INTERSECT_POLYTOPE_HH
+#define HPP_INTERSECT_POLYTOPE_HH
+
+#include <hpp/intersect/intersect.hh>
+
+namespace hpp {
+    namespace intersect {
+
+    /// \addtogroup intersect
+    /// \{
+
+        /// Convex polytope compiled from a set of inequalities for fast inside tests.
+        /// The rows of the inequalities are normalised and stored as one array per
+        /// coordinate of the normals and one array of offsets, so that a point is
+        /// tested against many planes at once with vectorised operations. Two spheres around the
+        /// same center classify most points without testing any plane: points inside
+        /// the inscribed sphere are inside, points out of the bounding sphere are outside.
+        class Polytope
+        {
+        public:
+          /// Empty polytope, which contains no point.
+          Polytope ();
+
+          /// Compile the inequalities of a convex object.
+          /// \param ineq inequalities of the object, see intersect::convexHullInequalities.
+          /// \param vertices vertices of the object, which give the bounding sphere.
+          Polytope (const Inequality& ineq, const std::vector<Eigen::Vector3d>& vertices);
+
+          /// Return true if a point is inside all planes of the polytope.
+          bool contains (const Eigen::Vector3d& point) const;
+
+          /// Same as above without the sphere tests: return true if a point is inside
+          /// all planes. The planes are tested by groups, stopping at the first group
+          /// with a plane the point is outside of.
+          bool insidePlanes (const Eigen::Vector3d& point) const;
+
+          /// Test many points at once, see intersect::is_inside.
+          /// \param points points to be tested, one per column.
+          /// \param inside filled with the increasing indices of the columns of points
+          ///        inside the polytope.
+          void contains (const Eigen::Matrix3Xd& points, std::vector<std::size_t>& inside) const;
+
+          /// Return true if a point is inside the polytope placed at a pose. The point
+          /// is moved to the frame of the polytope, which is left unchanged.
+          /// \param pose pose of the polytope in the frame of point.
+          /// \param point point to be tested.
+          bool contains (const fcl::Transform3f& pose, const Eigen::Vector3d& point) const;
+
+          /// Test many points at once against the polytope placed at a pose.
+          /// \param pose pose of the polytope in the frame of points.
+          /// \param points points to be tested, one per column.
+          /// \param inside filled with the increasing indices of the columns of points
+          ///        inside the polytope.
+          void contains (const fcl::Transform3f& pose, const Eigen::Matrix3Xd& points,
+                  std::vector<std::size_t>& inside) const;
+
+          /// Number of planes.
+          std::size_t size () const
+          {
+            return (std::size_t) offsets_.size ();
+          }
+
+          /// Signed distance of a point to plane k, positive outside.
+          double distance (const std::size_t k, const Eigen::Vector3d& point) const
+          {
+            return normalX_[k] * point[0] + normalY_[k] * point[1] + normalZ_[k] * point[2] -
+                offsets_[k];
+          }
+
+          /// Coordinate i of the unit normal of plane k.
+          double normal (const std::size_t k, const int i) const
+          {
+            return i == 0 ? normalX_[k] : (i == 1 ? normalY_[k] : normalZ_[k]);
+          }
+
+          /// Offset of plane k: the points x of the polytope satisfy normal.x <= offset.
+          double offset (const std::size_t k) const
+          {
+            return offsets_[k];
+          }
+
+          /// Center of the inscribed and bounding spheres.
+          const Eigen::Vector3d& center () const
+          {
+            return center_;
+          }
+
+          /// Radius of a sphere inside the polytope; negative if there is none.
+          double innerRadius () const
+          {
+            return innerRadius_;
+          }
+
+          /// Radius of a sphere containing the polytope; negative if it was built
+          /// without vertices.
+          double outerRadius () const
+          {
+            return outerRadius_;
+          }
+
+        private:
+          Eigen::VectorXd normalX_, normalY_, normalZ_, offsets_;
+          Eigen::Vector3d center_;
+          double innerRadius_;
+          double outerRadius_;
+        };
+
+        /// Compile the convex hull of a fcl::CollisionObject in the frame of its model.
+        /// Unlike fcl2inequalities (rom), the result does not depend on the pose of
+        /// the object: it is built once and the points are tested with
+        /// Polytope::contains (rom->getTransform (), ...) for any later pose.
+        /// \param rom fcl::CollisionObject whose hull is compiled.
+        Polytope fcl2polytope (const fcl::CollisionObjectPtr_t& rom);
+
+    /// \}
+
+    } // namespace intersect
+} // namespace hpp
+
+#endif // HPP_INTERSECT_POLYTOPE_HH
@@ -0,0 +1,125 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#ifndef HPP_INTERSECT_QUERY_CONTEXT_HH
+#define HPP_INTERSECT_QUERY_CONTEXT_HH
+
+#include <hpp/intersect/intersect.hh>
+
+namespace hpp {
+    namespace intersect {
+
+    /// \addtogroup intersect
+    /// \{
+
+        /// State kept between the queries of a rom moving along a trajectory against
+        /// one affordance. A traversal of the bounding volume hierarchies keeps all
+        /// triangle pairs whose bounding volumes are closer than a margin, and the
+        /// affordance vertices whose triangles are closer than the margin to the bounding
+        /// volume of the rom. As long as no point of the rom has moved by more than the
+        /// margin relative to the affordance since that traversal, the kept pairs contain
+        /// every pair that may intersect and the kept vertices every vertex that may be
+        /// inside the rom: only they are tested, without traversing the hierarchies
+        /// nor calling fcl::collide. A larger motion, or another pair of models,
+        /// triggers a new traversal.
+        /// A context is not thread safe: use one instance per trajectory.
+        class QueryContext
+        {
+        public:
+          /// \param margin distance under which triangle pairs are kept by a traversal.
+          ///        A larger margin allows larger motions between traversals, at the
+          ///        cost of more pairs tested by each query.
+          QueryContext (const double margin = 1e-2);
+
+          /// Forget the kept pairs and release the models: the next query traverses
+          /// the hierarchies.
+          void reset ();
+
+          /// Distance under which triangle pairs are kept by a traversal.
+          double margin () const
+          {
+            return margin_;
+          }
+
+          /// Number of queries that traversed the hierarchies since construction.
+          std::size_t traversals () const
+          {
+            return traversals_;
+          }
+
+          /// Number of queries that tested the kept pairs since construction.
+          std::size_t reuses () const
+          {
+            return reuses_;
+          }
+
+          /// Set the models of the next query. The kept pairs are dropped if the models
+          /// differ from those of the previous query.
+          void setModels (const BVHModelOBConst_Ptr_t& romModel,
+                  const BVHModelOBConst_Ptr_t& affModel);
+
+          /// Return true, and count a reuse, if the kept pairs contain all pairs that
+          /// may intersect with the rom at a given pose in the affordance model frame.
+          /// \param R, T rotation and translation of the rom in the affordance model frame.
+          bool reuse (const fcl::Matrix3f& R, const fcl::Vec3f& T);
+
+          /// Keep the pairs and vertices found by a traversal, and count it.
+          /// \param R, T rotation and translation of the rom in the affordance model frame.
+          /// \param pairs (affordance triangle, rom triangle) pairs closer than margin ().
+          /// \param vertices welded indices of the affordance vertices closer than
+          ///        margin () to the rom bounding volume.
+          void store (const fcl::Matrix3f& R, const fcl::Vec3f& T,
+                  const std::vector<std::pair<int, int> >& pairs,
+                  const std::vector<int>& vertices);
+
+          /// Pairs kept by the last traversal.
+          const std::vector<std::pair<int, int> >& pairs () const
+          {
+            return pairs_;
+          }
+
+          /// Affordance vertices kept by the last traversal.
+          const std::vector<int>& vertices () const
+          {
+            return vertices_;
+          }
+
+        private:
+          double margin_;
+          // models are kept to guarantee the pairs refer to their triangles
+          BVHModelOBConst_Ptr_t romModel_;
+          BVHModelOBConst_Ptr_t affModel_;
+          // distance from the rom model origin to its farthest point
+          double romRadius_;
+          bool valid_;
+          // pose of the rom in the affordance model frame at the last traversal
+          fcl::Matrix3f rotation_;
+          fcl::Vec3f translation_;
+          std::vector<std::pair<int, int> > pairs_;
+          std::vector<int> vertices_;
+          std::size_t traversals_;
+          std::size_t reuses_;
+        };
+
+    /// \}
+
+    } // namespace intersect
+} // namespace hpp
+
+#endif // HPP_INTERSECT_QUERY_CONTEXT_HH
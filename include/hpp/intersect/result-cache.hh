@@ -0,0 +1,94 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#ifndef HPP_INTERSECT_RESULT_CACHE_HH
+#define HPP_INTERSECT_RESULT_CACHE_HH
+
+#include <hpp/intersect/intersect.hh>
+
+namespace hpp {
+    namespace intersect {
+
+    /// \addtogroup intersect
+    /// \{
+
+        /// Cache of contact regions shared by the threads of a planner.
+        /// A region is stored for a pair of models and the pose of the affordance model
+        /// relative to the rom model, quantised to a translation and a rotation step:
+        /// queries whose relative poses fall in the same cell get the stored region,
+        /// moved with the rom. The regions depend on the intersect::IntersectionRequest
+        /// of the queries: use one cache per set of parameters.
+        /// The entries are split in shards, each with its own lock and least recently
+        /// used eviction, so that concurrent queries rarely wait for each other.
+        /// The models are kept alive by the cache until clear () is called.
+        class ResultCache
+        {
+        public:
+          /// \param capacity maximum number of regions kept, split evenly between shards.
+          /// \param resolution quantisation step of the relative translation.
+          /// \param angularResolution quantisation step of the relative rotation, in radians.
+          /// \param nShards number of independently locked parts of the cache.
+          ResultCache (const std::size_t capacity = 4096, const double resolution = 1e-3,
+                  const double angularResolution = 1e-3, const unsigned int nShards = 16);
+
+          /// Look up the region of a rom model and an affordance model at given poses.
+          /// On a hit, the stored region is written to region in world frame.
+          /// Returns true on a hit.
+          bool find (const BVHModelOBConst_Ptr_t& romModel, const fcl::Transform3f& romPose,
+                  const BVHModelOBConst_Ptr_t& affModel, const fcl::Transform3f& affPose,
+                  std::vector<Eigen::Vector3d>& region);
+
+          /// Store the region, in world frame, of a rom model and an affordance model at
+          /// given poses. The least recently used region of the shard is evicted if it is full.
+          void insert (const BVHModelOBConst_Ptr_t& romModel, const fcl::Transform3f& romPose,
+                  const BVHModelOBConst_Ptr_t& affModel, const fcl::Transform3f& affPose,
+                  const std::vector<Eigen::Vector3d>& region);
+
+          /// Number of lookups that found a region since construction or clear ().
+          std::size_t hits () const;
+
+          /// Number of lookups that found no region since construction or clear ().
+          std::size_t misses () const;
+
+          /// Number of regions stored.
+          std::size_t size () const;
+
+          /// Remove all regions, release the models and reset the counts.
+          void clear ();
+
+        private:
+          struct Key;
+          struct Shard;
+
+          /// Key of a pair of models at given poses.
+          Key key (const BVHModelOBConst_Ptr_t& romModel, const fcl::Transform3f& romPose,
+                  const BVHModelOBConst_Ptr_t& affModel, const fcl::Transform3f& affPose) const;
+
+          std::size_t shardCapacity_;
+          double resolution_;
+          double angularResolution_;
+          std::vector<boost::shared_ptr<Shard> > shards_;
+        };
+
+    /// \}
+
+    } // namespace intersect
+} // namespace hpp
+
+#endif // HPP_INTERSECT_RESULT_CACHE_HH
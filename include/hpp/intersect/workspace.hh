@@ -0,0 +1,88 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#ifndef HPP_INTERSECT_WORKSPACE_HH
+#define HPP_INTERSECT_WORKSPACE_HH
+
+#include <hpp/intersect/intersect.hh>
+#include <hpp/fcl/collision_data.h>
+
+namespace hpp {
+    namespace intersect {
+
+        struct DistanceTile;
+
+    /// \addtogroup intersect
+    /// \{
+
+        /// Scratch buffers of getIntersectionPoints.
+        /// The buffers are cleared but never shrunk between queries: they grow to
+        /// the largest query seen and are then reused, so that once a workspace has
+        /// served a query of a given size, a single threaded query of at most that
+        /// size does no heap allocation of its own.
+        /// A workspace is not thread safe: use one instance per thread.
+        class IntersectionWorkspace
+        {
+        public:
+          IntersectionWorkspace ();
+
+          /// Release the memory held by all buffers.
+          void clear ();
+
+          /// welded vertices of the mesh moved into the frame of the other one
+          std::vector<Eigen::Vector3d> vertices_;
+          /// triangles of the mesh moved into the frame of the other one
+          std::vector<TrianglePoints> triangles_;
+          /// planes of triangles_, which are the inequalities of the rom when it is
+          /// the mesh that is moved
+          Inequality inequality_;
+          /// contact points of the current query
+          std::vector<Eigen::Vector3d> points_;
+          /// contact points found by each chunk of a parallel query
+          std::vector<std::vector<Eigen::Vector3d> > partial_;
+          /// polygons being clipped by each chunk of a query with
+          /// intersect::CONVEX_CLIPPING, two per chunk
+          std::vector<std::vector<Eigen::Vector3d> > polygons_;
+          /// candidate (affordance triangle, rom triangle) pairs
+          std::vector<std::pair<int, int> > candidates_;
+          /// stack of the bounding volume hierarchy traversal
+          std::vector<std::pair<int, int> > stack_;
+          /// affordance vertices close to the rom found by the traversal of a query
+          /// with a intersect::QueryContext
+          std::vector<int> vertexIds_;
+          /// positions of the affordance vertices kept by a intersect::QueryContext
+          std::vector<Eigen::Vector3d> nearVertices_;
+          /// vertex to plane distances of the candidate pairs, one tile per chunk
+          std::vector<boost::shared_ptr<DistanceTile> > tiles_;
+          /// hash table used to merge close contact points
+          std::vector<int> pointTable_;
+          /// result of fcl::collide
+          fcl::CollisionResult collisionResult_;
+          /// convex hull of the contact points
+          std::vector<Eigen::Vector3d> hull_;
+          /// contact region returned by the query
+          std::vector<Eigen::Vector3d> region_;
+        };
+
+    /// \}
+
+    } // namespace intersect
+} // namespace hpp
+
+#endif // HPP_INTERSECT_WORKSPACE_HH
@@ -0,0 +1,179 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#include <hpp/intersect/cache.hh>
+#include <limits>
+
+namespace hpp {
+    namespace intersect {
+
+        MeshCache::ModelEntry& MeshCache::modelEntry (const BVHModelOBConst_Ptr_t& model)
+        {
+          std::map<const BVHModelOB*, ModelEntry>::iterator it = models_.find (model.get ());
+          if (it == models_.end ()) {
+              it = models_.insert (std::make_pair (model.get (), ModelEntry ())).first;
+              ModelEntry& entry = it->second;
+              entry.model_ = model;
+              weldMesh (*model, 1e-9, entry.mesh_);
+          }
+          return it->second;
+        }
+
+        const WeldedMesh& MeshCache::modelMesh (const BVHModelOBConst_Ptr_t& model)
+        {
+          return modelEntry (model).mesh_;
+        }
+
+        const std::vector<TrianglePoints>& MeshCache::modelTriangles
+            (const BVHModelOBConst_Ptr_t& model)
+        {
+          ModelEntry& entry = modelEntry (model);
+          if (!entry.hasTriangles_) {
+              std::vector<Eigen::Vector3d> vertices;
+              getTriangles (entry.mesh_, fcl::Transform3f (), vertices, entry.triangles_);
+              entry.hasTriangles_ = true;
+          }
+          return entry.triangles_;
+        }
+
+        const Inequality& MeshCache::modelInequality (const BVHModelOBConst_Ptr_t& model)
+        {
+          const std::vector<TrianglePoints>& triangles = modelTriangles (model);
+          ModelEntry& entry = modelEntry (model);
+          if (!entry.hasInequality_) {
+              entry.inequality_ = fcl2inequalities (triangles);
+              entry.hasInequality_ = true;
+          }
+          return entry.inequality_;
+        }
+
+        const Polytope& MeshCache::modelPolytope (const BVHModelOBConst_Ptr_t& model)
+        {
+          ModelEntry& entry = modelEntry (model);
+          if (!entry.hasPolytope_) {
+              // the hull inequalities are only needed to compile the polytope
+              const Eigen::MatrixXd empty;
+              Inequality hull (empty, Eigen::VectorXd (), empty, empty);
+              convexHullInequalities (entry.mesh_, hull);
+              entry.polytope_ = Polytope (hull, entry.mesh_.vertices_);
+              entry.hasPolytope_ = true;
+          }
+          return entry.polytope_;
+        }
+
+        // smallest value of normal.(R v + T) over the vertices v
+        double lowerSupport (const std::vector<Eigen::Vector3d>& vertices,
+                const Eigen::Vector3d& normal, const fcl::Matrix3f& R, const fcl::Vec3f& T)
+        {
+          // normal.(R v + T) = (R^T normal).v + normal.T: the vertices are not moved
+          const Eigen::Vector3d direction (R.transpose () * normal);
+          double res = std::numeric_limits<double>::max ();
+          for (std::size_t i = 0; i < vertices.size (); ++i) {
+              res = std::min (res, direction.dot (vertices[i]));
+          }
+          return res + normal.dot (T);
+        }
+
+        bool MeshCache::separated (const BVHModelOBConst_Ptr_t& romModel,
+                const BVHModelOBConst_Ptr_t& affModel, const fcl::Matrix3f& R,
+                const fcl::Vec3f& T)
+        {
+          std::map<PairKey_t, Witness>::iterator it =
+              witnesses_.find (PairKey_t (romModel.get (), affModel.get ()));
+          if (it == witnesses_.end ()) {
+              return false;
+          }
+          const Witness& witness = it->second;
+          const WeldedMesh& affMesh = modelMesh (affModel);
+          // bound of the support function given by the bounding sphere of the affordance model
+          const Eigen::Vector3d center (R * affMesh.center_ + T);
+          if (witness.normal_.dot (center) - affMesh.radius_ > witness.support_) {
+              return true;
+          }
+          // same with its bounding box, whose support is that of its center minus
+          // the projection of its half extents
+          const Eigen::Vector3d direction (R.transpose () * witness.normal_);
+          if (direction.dot (affMesh.center_) - .5 * direction.cwiseAbs ().dot (affMesh.max_ - affMesh.min_) +
+                  witness.normal_.dot (T) > witness.support_) {
+              return true;
+          }
+          if (lowerSupport (affMesh.vertices_, witness.normal_, R, T) > witness.support_) {
+              return true;
+          }
+          witnesses_.erase (it);
+          return false;
+        }
+
+        bool MeshCache::findSeparation (const BVHModelOBConst_Ptr_t& romModel,
+                const BVHModelOBConst_Ptr_t& affModel, const fcl::Matrix3f& R,
+                const fcl::Vec3f& T)
+        {
+          const Polytope& rom = modelPolytope (romModel);
+          const WeldedMesh& romMesh = modelMesh (romModel);
+          const WeldedMesh& affMesh = modelMesh (affModel);
+          const std::vector<Eigen::Vector3d>& romVertices = romMesh.vertices_;
+          const std::vector<Eigen::Vector3d>& affVertices = affMesh.vertices_;
+          const Eigen::Vector3d affCenter (R * affMesh.center_ + T);
+          Witness witness;
+          // the hull plane the affordance is farthest out of: its offset is the support
+          // of the rom, and the bounding sphere of the affordance often suffices
+          std::size_t best = 0;
+          double bestGap = -std::numeric_limits<double>::max ();
+          for (std::size_t k = 0; k < rom.size (); ++k) {
+              const double gap (rom.distance (k, affCenter));
+              if (gap > bestGap) {
+                  best = k;
+                  bestGap = gap;
+              }
+          }
+          if (rom.size () > 0) {
+              witness.normal_ = Eigen::Vector3d (rom.normal (best, 0), rom.normal (best, 1),
+                      rom.normal (best, 2));
+              witness.support_ = rom.offset (best);
+              if (bestGap > affMesh.radius_ ||
+                      lowerSupport (affVertices, witness.normal_, R, T) > witness.support_) {
+                  witnesses_[PairKey_t (romModel.get (), affModel.get ())] = witness;
+                  return true;
+              }
+          }
+          // plane orthogonal to the line between the centers of the models
+          const Eigen::Vector3d axis (affCenter - romMesh.center_);
+          if (axis.squaredNorm () == 0. || romVertices.empty ()) {
+              return false;
+          }
+          witness.normal_ = axis.normalized ();
+          witness.support_ = -std::numeric_limits<double>::max ();
+          for (std::size_t i = 0; i < romVertices.size (); ++i) {
+              witness.support_ = std::max (witness.support_, witness.normal_.dot (romVertices[i]));
+          }
+          if (lowerSupport (affVertices, witness.normal_, R, T) > witness.support_) {
+              witnesses_[PairKey_t (romModel.get (), affModel.get ())] = witness;
+              return true;
+          }
+          return false;
+        }
+
+        void MeshCache::clear ()
+        {
+          models_.clear ();
+          witnesses_.clear ();
+        }
+
+    } // namespace intersect
+} // namespace hpp
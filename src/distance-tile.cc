@@ -0,0 +1,205 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#include "distance-tile.hh"
+
+#if defined (__AVX__)
+# include <immintrin.h>
+#elif defined (__SSE2__)
+# include <emmintrin.h>
+#endif
+
+namespace hpp {
+    namespace intersect {
+        namespace {
+#if defined (__AVX__)
+          // one AVX register holds the four lanes of a block of pairs
+          struct Pack { __m256d v; };
+          inline Pack make (const __m256d v) { Pack r; r.v = v; return r; }
+          inline Pack load (const double* p) { return make (_mm256_loadu_pd (p)); }
+          inline Pack operator& (const Pack& a, const Pack& b) { return make (_mm256_and_pd (a.v, b.v)); }
+          inline Pack operator| (const Pack& a, const Pack& b) { return make (_mm256_or_pd (a.v, b.v)); }
+          inline Pack lessThanZero (const Pack& a)
+          { return make (_mm256_cmp_pd (a.v, _mm256_setzero_pd (), _CMP_LT_OQ)); }
+          inline Pack greaterThanZero (const Pack& a)
+          { return make (_mm256_cmp_pd (a.v, _mm256_setzero_pd (), _CMP_GT_OQ)); }
+          inline unsigned int laneMask (const Pack& a)
+          { return (unsigned int) _mm256_movemask_pd (a.v); }
+#elif defined (__SSE2__)
+          // two SSE2 registers hold the four lanes of a block of pairs
+          struct Pack { __m128d lo, hi; };
+          inline Pack make (const __m128d lo, const __m128d hi) { Pack r; r.lo = lo; r.hi = hi; return r; }
+          inline Pack load (const double* p) { return make (_mm_loadu_pd (p), _mm_loadu_pd (p + 2)); }
+          inline Pack operator& (const Pack& a, const Pack& b)
+          { return make (_mm_and_pd (a.lo, b.lo), _mm_and_pd (a.hi, b.hi)); }
+          inline Pack operator| (const Pack& a, const Pack& b)
+          { return make (_mm_or_pd (a.lo, b.lo), _mm_or_pd (a.hi, b.hi)); }
+          inline Pack lessThanZero (const Pack& a)
+          { return make (_mm_cmplt_pd (a.lo, _mm_setzero_pd ()), _mm_cmplt_pd (a.hi, _mm_setzero_pd ())); }
+          inline Pack greaterThanZero (const Pack& a)
+          { return make (_mm_cmpgt_pd (a.lo, _mm_setzero_pd ()), _mm_cmpgt_pd (a.hi, _mm_setzero_pd ())); }
+          inline unsigned int laneMask (const Pack& a)
+          { return (unsigned int) (_mm_movemask_pd (a.lo) | (_mm_movemask_pd (a.hi) << 2)); }
+#else
+          // portable fallback: lanes are processed one after the other,
+          // comparison results are stored as 0.0 or 1.0
+          struct Pack { double v[DISTANCE_TILE_LANES]; };
+          inline Pack load (const double* p)
+          { Pack r; for (unsigned int k = 0; k < DISTANCE_TILE_LANES; ++k) r.v[k] = p[k]; return r; }
+          inline Pack operator& (const Pack& a, const Pack& b)
+          { Pack r; for (unsigned int k = 0; k < DISTANCE_TILE_LANES; ++k) r.v[k] = a.v[k] * b.v[k]; return r; }
+          inline Pack operator| (const Pack& a, const Pack& b)
+          { Pack r; for (unsigned int k = 0; k < DISTANCE_TILE_LANES; ++k) r.v[k] = (a.v[k] + b.v[k] > 0.0); return r; }
+          inline Pack lessThanZero (const Pack& a)
+          { Pack r; for (unsigned int k = 0; k < DISTANCE_TILE_LANES; ++k) r.v[k] = (a.v[k] < 0.0); return r; }
+          inline Pack greaterThanZero (const Pack& a)
+          { Pack r; for (unsigned int k = 0; k < DISTANCE_TILE_LANES; ++k) r.v[k] = (a.v[k] > 0.0); return r; }
+          inline unsigned int laneMask (const Pack& a)
+          {
+            unsigned int mask = 0;
+            for (unsigned int k = 0; k < DISTANCE_TILE_LANES; ++k) mask |= (a.v[k] > 0.0) << k;
+            return mask;
+          }
+#endif
+
+          // lanes whose three signed distances are all strictly negative or all strictly positive
+          inline unsigned int separatedLanes (const double* d1, const double* d2, const double* d3)
+          {
+            const Pack p1 (load (d1)), p2 (load (d2)), p3 (load (d3));
+            const Pack allNeg = lessThanZero (p1) & lessThanZero (p2) & lessThanZero (p3);
+            const Pack allPos = greaterThanZero (p1) & greaterThanZero (p2) & greaterThanZero (p3);
+            return laneMask (allNeg | allPos);
+          }
+
+          // slot of element id in the tile, assigned to the next free slot on first use
+          inline int slot (std::vector<int>& slots, const int id, int* ids, int& n)
+          {
+            if (slots[id] < 0) {
+                ids[n] = id;
+                slots[id] = n++;
+            }
+            return slots[id];
+          }
+
+          // make sure slots covers n elements, all of them absent from the tile
+          inline void prepare (std::vector<int>& slots, const int n)
+          {
+            if (slots.size () != (std::size_t) n) {
+                slots.assign (n, -1);
+            }
+          }
+
+          inline void release (std::vector<int>& slots, const int* ids, const int n)
+          {
+            for (int k = 0; k < n; ++k) {
+                slots[ids[k]] = -1;
+            }
+          }
+
+          inline const fcl::Vec3f& corner (const TrianglePoints& tri, const int c)
+          {
+            return c == 0 ? tri.p1 : (c == 1 ? tri.p2 : tri.p3);
+          }
+        } // namespace
+
+        void DistanceTile::set (const WeldedMesh& romMesh, const std::vector<TrianglePoints>& romTris,
+                const Inequality& romPlanes, const WeldedMesh& affMesh,
+                const std::vector<TrianglePoints>& affTris, const Inequality& affPlanes,
+                const std::pair<int, int>* first, const std::pair<int, int>* last)
+        {
+          assert (last > first && last - first <= (int) DISTANCE_TILE_SIZE);
+          prepare (romVertexSlot_, (int) romMesh.vertices_.size ());
+          prepare (affVertexSlot_, (int) affMesh.vertices_.size ());
+          prepare (romPlaneSlot_, (int) romMesh.degenerate_.size ());
+          prepare (affPlaneSlot_, (int) affMesh.degenerate_.size ());
+          int nRomVertices (0), nAffVertices (0), nRomPlanes (0), nAffPlanes (0);
+          romPoints_.resize (3*(last - first), 4);
+          affPoints_.resize (3*(last - first), 4);
+          romPlanes_.resize (last - first, 4);
+          affPlanes_.resize (last - first, 4);
+
+          // gather the unique vertices and planes of the tile
+          for (unsigned int k = 0; first + k != last; ++k) {
+              const int aff = first[k].first;
+              const int rom = first[k].second;
+              for (int c = 0; c < 3; ++c) {
+                  int n = nRomVertices;
+                  romVertex_[k][c] = slot (romVertexSlot_, romMesh.indices_[3*rom + c],
+                          romVertexIds_, nRomVertices);
+                  if (n != nRomVertices) {
+                      const fcl::Vec3f& p = corner (romTris[rom], c);
+                      romPoints_.row (n) << p[0], p[1], p[2], 1.;
+                  }
+                  n = nAffVertices;
+                  affVertex_[k][c] = slot (affVertexSlot_, affMesh.indices_[3*aff + c],
+                          affVertexIds_, nAffVertices);
+                  if (n != nAffVertices) {
+                      const fcl::Vec3f& p = corner (affTris[aff], c);
+                      affPoints_.row (n) << p[0], p[1], p[2], 1.;
+                  }
+              }
+              int n = nRomPlanes;
+              romPlane_[k] = slot (romPlaneSlot_, rom, romPlaneIds_, nRomPlanes);
+              if (n != nRomPlanes) {
+                  romPlanes_.row (n) << romPlanes.A_ (rom, 0), romPlanes.A_ (rom, 1),
+                      romPlanes.A_ (rom, 2), -romPlanes.b_ (rom);
+              }
+              n = nAffPlanes;
+              affPlane_[k] = slot (affPlaneSlot_, aff, affPlaneIds_, nAffPlanes);
+              if (n != nAffPlanes) {
+                  affPlanes_.row (n) << affPlanes.A_ (aff, 0), affPlanes.A_ (aff, 1),
+                      affPlanes.A_ (aff, 2), -affPlanes.b_ (aff);
+              }
+          }
+
+          // all vertex to plane distances of the tile at once
+          affToRom_.resize (nAffVertices, nRomPlanes);
+          affToRom_.noalias () = affPoints_.topRows (nAffVertices) *
+              romPlanes_.topRows (nRomPlanes).transpose ();
+          romToAff_.resize (nRomVertices, nAffPlanes);
+          romToAff_.noalias () = romPoints_.topRows (nRomVertices) *
+              affPlanes_.topRows (nAffPlanes).transpose ();
+
+          // plane-side rejection by blocks of pairs: the distances of each block are
+          // gathered lane by lane, unused lanes repeat the first pair of the block
+          const unsigned int nPairs ((unsigned int) (last - first));
+          double a2r[3][DISTANCE_TILE_LANES], r2a[3][DISTANCE_TILE_LANES];
+          for (unsigned int block = 0; block < nPairs; block += DISTANCE_TILE_LANES) {
+              for (unsigned int l = 0; l < DISTANCE_TILE_LANES; ++l) {
+                  const unsigned int k = block + l < nPairs ? block + l : block;
+                  for (int c = 0; c < 3; ++c) {
+                      a2r[c][l] = affToRom_ (affVertex_[k][c], romPlane_[k]);
+                      r2a[c][l] = romToAff_ (romVertex_[k][c], affPlane_[k]);
+                  }
+              }
+              const unsigned int separated (separatedLanes (a2r[0], a2r[1], a2r[2]) |
+                      separatedLanes (r2a[0], r2a[1], r2a[2]));
+              for (unsigned int l = 0; l < DISTANCE_TILE_LANES && block + l < nPairs; ++l) {
+                  overlaps_[block + l] = !(separated & (1u << l));
+              }
+          }
+
+          release (romVertexSlot_, romVertexIds_, nRomVertices);
+          release (affVertexSlot_, affVertexIds_, nAffVertices);
+          release (romPlaneSlot_, romPlaneIds_, nRomPlanes);
+          release (affPlaneSlot_, affPlaneIds_, nAffPlanes);
+        }
+
+    } // namespace intersect
+} // namespace hpp
@@ -0,0 +1,104 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#ifndef HPP_INTERSECT_DISTANCE_TILE_HH
+#define HPP_INTERSECT_DISTANCE_TILE_HH
+
+#include <hpp/intersect/intersect.hh>
+
+namespace hpp {
+    namespace intersect {
+
+        /// maximum number of candidate pairs whose distances are computed together
+        const unsigned int DISTANCE_TILE_SIZE = 64;
+
+        /// number of pairs of a tile whose sign patterns are tested at once
+        const unsigned int DISTANCE_TILE_LANES = 4;
+
+        /// Signed distances between the vertices of the triangles of a tile of candidate
+        /// (affordance triangle, rom triangle) pairs and the planes of the triangles of the
+        /// other mesh. Vertices are identified by their index in the welded mesh, so that a
+        /// vertex shared by several triangles of the tile appears once. The distances of all tile
+        /// vertices of one mesh to all tile planes of the other mesh are computed with one
+        /// matrix product, [x y z 1] times the stacked planes [C C3]^T. The plane-side
+        /// rejection of the Moller test is then run on the distances of
+        /// DISTANCE_TILE_LANES pairs at once, with AVX or SSE2 when available.
+        struct DistanceTile
+        {
+          typedef Eigen::Matrix<double, Eigen::Dynamic, 4, Eigen::RowMajor,
+                  3*DISTANCE_TILE_SIZE, 4> Points_t;
+          typedef Eigen::Matrix<double, Eigen::Dynamic, 4, Eigen::RowMajor,
+                  DISTANCE_TILE_SIZE, 4> Planes_t;
+          typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor,
+                  3*DISTANCE_TILE_SIZE, DISTANCE_TILE_SIZE> Distances_t;
+
+          /// Compute the distances of the pairs [first, last), with
+          /// last - first <= DISTANCE_TILE_SIZE. Triangles are given in a common frame,
+          /// their planes are read from romPlanes and affPlanes,
+          /// see intersect::fcl2inequalities.
+          void set (const WeldedMesh& romMesh, const std::vector<TrianglePoints>& romTris,
+                  const Inequality& romPlanes, const WeldedMesh& affMesh,
+                  const std::vector<TrianglePoints>& affTris, const Inequality& affPlanes,
+                  const std::pair<int, int>* first, const std::pair<int, int>* last);
+
+          /// Return false if the vertices of one triangle of pair k of the tile are all
+          /// strictly on one side of the plane of the other: the triangles do not intersect.
+          bool overlaps (const unsigned int k) const
+          {
+            return overlaps_[k];
+          }
+
+          /// Signed distances of the vertices of the affordance triangle of pair k of the
+          /// tile to the rom plane (a2r), and of the rom vertices to the affordance plane (r2a).
+          void distances (const unsigned int k, Eigen::Vector3d& a2r, Eigen::Vector3d& r2a) const
+          {
+            const int* rv = romVertex_[k];
+            const int* av = affVertex_[k];
+            a2r << affToRom_ (av[0], romPlane_[k]), affToRom_ (av[1], romPlane_[k]),
+                affToRom_ (av[2], romPlane_[k]);
+            r2a << romToAff_ (rv[0], affPlane_[k]), romToAff_ (rv[1], affPlane_[k]),
+                romToAff_ (rv[2], affPlane_[k]);
+          }
+
+          EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        private:
+          // slot in the tile of each vertex (resp. triangle) of a mesh, -1 if absent.
+          // Only the entries of the current tile are set, they are reset at the end of set ().
+          std::vector<int> romVertexSlot_, affVertexSlot_, romPlaneSlot_, affPlaneSlot_;
+          // mesh indices of the vertices and triangles of the tile, in slot order
+          int romVertexIds_[3*DISTANCE_TILE_SIZE], affVertexIds_[3*DISTANCE_TILE_SIZE];
+          int romPlaneIds_[DISTANCE_TILE_SIZE], affPlaneIds_[DISTANCE_TILE_SIZE];
+          // slots of the vertices and planes of each pair of the tile
+          int romVertex_[DISTANCE_TILE_SIZE][3], affVertex_[DISTANCE_TILE_SIZE][3];
+          int romPlane_[DISTANCE_TILE_SIZE], affPlane_[DISTANCE_TILE_SIZE];
+          // homogeneous coordinates of the vertices and planes of the tile
+          Points_t romPoints_, affPoints_;
+          Planes_t romPlanes_, affPlanes_;
+          // affToRom_ (i, j): distance of affordance vertex i to rom plane j,
+          // romToAff_ (i, j): distance of rom vertex i to affordance plane j
+          Distances_t affToRom_, romToAff_;
+          // result of the plane-side rejection of each pair of the tile
+          bool overlaps_[DISTANCE_TILE_SIZE];
+        };
+
+    } // namespace intersect
+} // namespace hpp
+
+#endif // HPP_INTERSECT_DISTANCE_TILE_HH
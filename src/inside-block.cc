@@ -0,0 +1,102 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#include "inside-block.hh"
+#include <algorithm>
+#include <limits>
+
+namespace hpp {
+    namespace intersect {
+
+        namespace {
+          // keep at the front of block the points inside all planes, see insideBlock
+          template <typename Planes>
+          int planesBlock (const Planes& planes, PointBlock_t& block, const int nPoints, int* ids)
+          {
+            typedef Eigen::Array<double, 1, Eigen::Dynamic, Eigen::RowMajor,
+                    1, INSIDE_BLOCK_SIZE> Distances_t;
+            Distances_t maxDist;
+            int nInside = nPoints;
+            const int nPlanes ((int) planes.size ());
+            for (int first = 0; first < nPlanes && nInside > 0; first += INSIDE_PLANE_BLOCK) {
+                const int last (std::min (first + INSIDE_PLANE_BLOCK, nPlanes));
+                maxDist.setConstant (nInside, -std::numeric_limits<double>::infinity ());
+                for (int k = first; k < last; ++k) {
+                    maxDist = maxDist.max (planes.normal (k, 0) * block.row (0).head (nInside).array () +
+                            planes.normal (k, 1) * block.row (1).head (nInside).array () +
+                            planes.normal (k, 2) * block.row (2).head (nInside).array () -
+                            planes.offset (k));
+                }
+                // keep the points inside all planes of this block at the front
+                int kept = 0;
+                for (int i = 0; i < nInside; ++i) {
+                    if (!(maxDist(i) > 0.)) {
+                        if (kept != i) {
+                            block.col (kept) = block.col (i);
+                            ids[kept] = ids[i];
+                        }
+                        ++kept;
+                    }
+                }
+                nInside = kept;
+            }
+            return nInside;
+          }
+        } // namespace
+
+        int insideBlock (const Inequality& ineq, PointBlock_t& block, const int nPoints, int* ids)
+        {
+          for (int i = 0; i < nPoints; ++i) {
+              ids[i] = i;
+          }
+          return planesBlock (InequalityPlanes (ineq), block, nPoints, ids);
+        }
+
+        int insideBlock (const Polytope& polytope, PointBlock_t& block, const int nPoints, int* ids)
+        {
+          typedef Eigen::Array<double, 1, Eigen::Dynamic, Eigen::RowMajor,
+                  1, INSIDE_BLOCK_SIZE> Distances_t;
+          if (polytope.size () == 0) {
+              return 0;
+          }
+          const Eigen::Vector3d& center = polytope.center ();
+          const double inner2 (polytope.innerRadius () < 0. ? -1. :
+                  polytope.innerRadius () * polytope.innerRadius ());
+          // no bounding sphere without vertices
+          const double outer2 (polytope.outerRadius () < 0. ? std::numeric_limits<double>::infinity () :
+                  polytope.outerRadius () * polytope.outerRadius ());
+          const Distances_t d2 ((block.row (0).head (nPoints).array () - center[0]).square () +
+                  (block.row (1).head (nPoints).array () - center[1]).square () +
+                  (block.row (2).head (nPoints).array () - center[2]).square ());
+          // keep the points inside at the front, in their original order
+          int nInside = 0;
+          for (int i = 0; i < nPoints; ++i) {
+              if (d2 (i) <= inner2 ||
+                      (d2 (i) <= outer2 && polytope.insidePlanes (block.col (i)))) {
+                  if (nInside != i) {
+                      block.col (nInside) = block.col (i);
+                  }
+                  ids[nInside++] = i;
+              }
+          }
+          return nInside;
+        }
+
+    } // namespace intersect
+} // namespace hpp
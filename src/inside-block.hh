@@ -0,0 +1,84 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#ifndef HPP_INTERSECT_INSIDE_BLOCK_HH
+#define HPP_INTERSECT_INSIDE_BLOCK_HH
+
+#include <hpp/intersect/intersect.hh>
+#include <hpp/intersect/polytope.hh>
+
+namespace hpp {
+    namespace intersect {
+
+        /// number of points tested together by insideBlock
+        const int INSIDE_BLOCK_SIZE = 64;
+        /// number of planes whose distances to the points are computed in one product
+        const int INSIDE_PLANE_BLOCK = 8;
+
+        /// block of points stored by column, without heap allocation. Coordinates are
+        /// stored by row so that one coordinate of all points is contiguous.
+        typedef Eigen::Matrix<double, 3, Eigen::Dynamic, Eigen::RowMajor,
+                3, INSIDE_BLOCK_SIZE> PointBlock_t;
+
+        /// Planes of a set of inequalities with the interface of intersect::Polytope.
+        /// Rows are not normalised: distances are only meaningful by their sign.
+        struct InequalityPlanes
+        {
+          InequalityPlanes (const Inequality& ineq): ineq_ (ineq) {}
+          std::size_t size () const
+          {
+            return (std::size_t) ineq_.b_.size ();
+          }
+          double distance (const std::size_t k, const Eigen::Vector3d& point) const
+          {
+            return ineq_.A_.row (k).dot (point) - ineq_.b_(k);
+          }
+          double normal (const std::size_t k, const int i) const
+          {
+            return ineq_.A_ (k, i);
+          }
+          double offset (const std::size_t k) const
+          {
+            return ineq_.b_ (k);
+          }
+          const Inequality& ineq_;
+        };
+
+        /// Test a block of points against a set of inequalities, see intersect::is_inside.
+        /// The distances of all points of the block to one plane are computed together,
+        /// as a vectorised combination of the coordinate rows. After every
+        /// INSIDE_PLANE_BLOCK planes, the points found outside are removed from the block,
+        /// so that a point found outside is not tested any further.
+        /// \param ineq object comprising the planes that form inequalities.
+        /// \param block points to test; on return, its first columns are the points
+        ///        inside, in their original order.
+        /// \param nPoints number of points in block, at most INSIDE_BLOCK_SIZE.
+        /// \param ids filled with the original column of each point inside.
+        /// \return the number of points inside.
+        int insideBlock (const Inequality& ineq, PointBlock_t& block, const int nPoints, int* ids);
+
+        /// Same as above for a compiled polytope: the points inside its inscribed sphere
+        /// or out of its bounding sphere are classified first, only the others are
+        /// tested against the planes, one at a time, see Polytope::insidePlanes.
+        int insideBlock (const Polytope& polytope, PointBlock_t& block, const int nPoints, int* ids);
+
+    } // namespace intersect
+} // namespace hpp
+
+#endif // HPP_INTERSECT_INSIDE_BLOCK_HH
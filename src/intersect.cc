@@ -18,20 +18,26 @@
 //
 //
 #include <hpp/intersect/intersect.hh>
+#include <hpp/intersect/cache.hh>
+#include <hpp/intersect/workspace.hh>
+#include <hpp/intersect/result-cache.hh>
+#include <hpp/intersect/query-context.hh>
+#include "distance-tile.hh"
+#include "inside-block.hh"
+#include "merge-points.hh"
+#include "quickhull.hh"
+#include "resample-hull.hh"
+#include "thread-pool.hh"
 #include <hpp/intersect/geom/algorithms.h>
 #include <hpp/fcl/collision.h>
+#include <hpp/fcl/BV/OBBRSS.h>
 #include <limits>
+#include <algorithm>
 #include <boost/math/special_functions/sign.hpp>
 
 namespace hpp {
     namespace intersect {
 
-        // helper class to save triangle vertex positions in world frame
-        struct TrianglePoints
-        {   
-            fcl::Vec3f p1, p2, p3; 
-        };
-
         std::vector<double> getRadius (const Eigen::VectorXd& params,
                 Eigen::Vector2d& centroid, double& tau)
         {
@@ -267,45 +273,147 @@ namespace hpp {
             return model;
         }
 
+        void getTriangles (const BVHModelOB& model, const fcl::Transform3f& tf,
+                std::vector<TrianglePoints>& triangles)
+        {
+          triangles.resize (model.num_tris);
+          for (int k = 0; k < model.num_tris; ++k) {
+              fcl::Triangle fcltri = model.tri_indices[k];
+              triangles[k].p1 = tf.getRotation() * model.vertices[fcltri[0]] + tf.getTranslation();
+              triangles[k].p2 = tf.getRotation() * model.vertices[fcltri[1]] + tf.getTranslation();
+              triangles[k].p3 = tf.getRotation() * model.vertices[fcltri[2]] + tf.getTranslation();
+          }
+        }
+
+        void getTriangles (const WeldedMesh& mesh, const fcl::Transform3f& tf,
+                std::vector<Eigen::Vector3d>& vertices, std::vector<TrianglePoints>& triangles)
+        {
+          vertices.resize (mesh.vertices_.size ());
+          for (std::size_t k = 0; k < vertices.size (); ++k) {
+              vertices[k] = tf.getRotation () * mesh.vertices_[k] + tf.getTranslation ();
+          }
+          triangles.resize (mesh.degenerate_.size ());
+          for (std::size_t k = 0; k < triangles.size (); ++k) {
+              triangles[k].p1 = vertices[mesh.indices_[3*k]];
+              triangles[k].p2 = vertices[mesh.indices_[3*k + 1]];
+              triangles[k].p3 = vertices[mesh.indices_[3*k + 2]];
+          }
+        }
+
+        void getWorldTriangles (const fcl::CollisionObjectPtr_t& object,
+                std::vector<TrianglePoints>& triangles)
+        {
+          getTriangles (*GetModel (object), object->getTransform (), triangles);
+        }
+
+        // Dual-tree traversal of the OBBRSS hierarchies of two models. Collects the
+        // (affordance triangle, rom triangle) index pairs whose leaf bounding volumes
+        // overlap; only these pairs can intersect. R and T describe the pose of the
+        // rom model frame in the affordance model frame.
+        // stack is a scratch buffer for the traversal.
+        void collectCandidatePairs (const BVHModelOB& affModel, const BVHModelOB& romModel,
+                const fcl::Matrix3f& R, const fcl::Vec3f& T, const double margin,
+                std::vector<std::pair<int, int> >& pairs, std::vector<std::pair<int, int> >& stack)
+        {
+          pairs.clear ();
+          stack.clear ();
+          if (affModel.getNumBVs () == 0 || romModel.getNumBVs () == 0) {
+              return;
+          }
+          stack.push_back (std::make_pair (0, 0));
+          while (!stack.empty ()) {
+              const int affId = stack.back ().first;
+              const int romId = stack.back ().second;
+              stack.pop_back ();
+              const fcl::BVNode<fcl::OBBRSS>& affNode = affModel.getBV (affId);
+              const fcl::BVNode<fcl::OBBRSS>& romNode = romModel.getBV (romId);
+              if (!fcl::overlap (R, T, affNode.bv, romNode.bv) &&
+                      (margin <= 0. || fcl::distance (R, T, affNode.bv, romNode.bv) > margin)) {
+                  continue;
+              }
+              if (affNode.isLeaf () && romNode.isLeaf ()) {
+                  pairs.push_back (std::make_pair (affNode.primitiveId (), romNode.primitiveId ()));
+                  continue;
+              }
+              // descend into the node covering more triangles to keep the
+              // two sides of the traversal balanced
+              if (romNode.isLeaf () || (!affNode.isLeaf () &&
+                          affNode.num_primitives >= romNode.num_primitives)) {
+                  stack.push_back (std::make_pair (affNode.leftChild (), romId));
+                  stack.push_back (std::make_pair (affNode.rightChild (), romId));
+              } else {
+                  stack.push_back (std::make_pair (affId, romNode.leftChild ()));
+                  stack.push_back (std::make_pair (affId, romNode.rightChild ()));
+              }
+          }
+        }
+
+        // order candidate pairs by rom triangle so that all affordance triangles
+        // tested against one rom triangle are contiguous
+        bool romTriangleLess (const std::pair<int, int>& a, const std::pair<int, int>& b)
+        {
+          return a.second < b.second || (a.second == b.second && a.first < b.first);
+        }
+
+        // Intersection segment of two triangles: size is 0 if the triangles do not
+        // intersect, 2 otherwise.
+        struct TriangleSegment
+        {
+          TriangleSegment (): size (0) {}
+          unsigned int size;
+          Eigen::Vector3d points[2];
+        };
+
+        // Interval covered by a triangle along the line L = p + tD, given the projections
+        // proj of its vertices on D and their signed distances dist to the other plane.
+        // The ends of the interval lie on the two edges leaving the vertex that is alone
+        // on its side of the other plane; the vertex is found with sign comparisons
+        // instead of branching over all vertex orderings.
+        void lineInterval (const double proj[3], const double dist[3], double& tmin, double& tmax)
+        {
+          // vertex alone on its side of the plane, and the two other vertices
+          static const int first[3] = {1, 0, 0};
+          static const int second[3] = {2, 2, 1};
+          const int s0 (boost::math::sign (dist[0]));
+          const int lonely = (s0 == boost::math::sign (dist[1])) ? 2 :
+              ((s0 == boost::math::sign (dist[2])) ? 1 : 0);
+          const int a (first[lonely]), b (second[lonely]);
+          const double t0 = proj[a] + (proj[lonely] - proj[a])*(dist[a])/(dist[a]-dist[lonely]);
+          const double t1 = proj[lonely] + (proj[b] - proj[lonely])*(dist[lonely])/(dist[lonely]-dist[b]);
+          tmin = std::min (t0, t1);
+          tmax = std::max (t0, t1);
+        }
+
+        // Plane C.x + C3 = 0 of triangle k, read from the triangle planes of a mesh
+        // (row k of A_ and b_, see fcl2inequalities).
+        inline void trianglePlane (const Inequality& planes, const int k,
+                Eigen::Vector3d& C, double& C3)
+        {
+          C << planes.A_ (k, 0), planes.A_ (k, 1), planes.A_ (k, 2);
+          C3 = -planes.b_ (k);
+        }
+
+        // True if the signed distances of the three vertices of a triangle to a plane
+        // all have the same sign and are not zero: the triangle lies on one side of the plane.
+        inline bool separated (const Eigen::Vector3d& dist)
+        {
+          return (dist[0] < 0 && dist[1] < 0 && dist[2] < 0) || (dist[0] > 0 && dist[1] > 0 && dist[2] > 0);
+        }
+
         // A Fast Triangle-Triangle Intersection Test by Tomas Mller
-        std::vector<Eigen::Vector3d> TriangleIntersection (const TrianglePoints& rom, const TrianglePoints& aff)
+        // The planes of both triangles are given by the caller, as well as the signed distances
+        // a2r of the vertices of aff to the plane of rom and r2a of the vertices of rom to the
+        // plane of aff (multiplied by the squared norm of the plane normal).
+        TriangleSegment TriangleIntersection (const TrianglePoints& rom, const Eigen::Vector3d& romC,
+                const double romC3, const TrianglePoints& aff, const Eigen::Vector3d& affC,
+                const double affC3, const Eigen::Vector3d& a2r, const Eigen::Vector3d& r2a)
         {
          //plane equation C(0)x + C(1)y + C(2)z + C3 = 0
-         Eigen::Vector3d romC;
-         double romC3;
-         Eigen::Vector3d affC;
-         double affC3;
-         std::vector<Eigen::Vector3d> res;
-         double X (0.0);
-         double Y (0.0);
-         double Z (0.0);
-
-         romC << (rom.p2 - rom.p1).cross (rom.p3 - rom.p1);
-         //romC.normalize ();
-         romC3 = (-romC).dot (rom.p1);
-
-         // signed distances from the vertices of aff to the plane of rom
-         // (multiplied by a constant romC.block(0,0,3,1) dot romC.block(0,0,3,1))
-         Eigen::Vector3d a2r (romC.dot(aff.p1) + romC3,
-                 romC.dot(aff.p2) + romC3,
-                 romC.dot(aff.p3) + romC3);
-         // if all distances have the same sign and are not zero, no overlap exists
-         if ((a2r[0] < 0 && a2r[1] < 0 && a2r[2] < 0) || (a2r[0] > 0 && a2r[1] > 0 && a2r[2] > 0)) {
-            res.clear ();
-            return res;// return empty vector;
-         }
-
-         //same procedure needed for affC
-         affC << (aff.p2 - aff.p1).cross (aff.p3 - aff.p1);
-         //affC.normalize ();
-         affC3 = (-affC).dot (aff.p1);
+         TriangleSegment res;
 
-         Eigen::Vector3d r2a (affC.dot(rom.p1) + affC3,
-                 affC.dot(rom.p2) + affC3,
-                 affC.dot(rom.p3) + affC3);
-         if ((r2a[0] < 0 && r2a[1] < 0 && r2a[2] < 0) || (r2a[0] > 0 && r2a[1] > 0 && r2a[2] > 0)) {
-            res.clear ();
-            return res;
+         // if all distances have the same sign and are not zero, no overlap exists
+         if (separated (a2r) || separated (r2a)) {
+            return res;// return empty segment;
          }
 
         // if we get this far, triangles intersect or are coplanar
@@ -314,136 +422,162 @@ namespace hpp {
             // deal with coplanar triangles and return?
         }
         // The intersection of aff and rom planes is a line L = p +tD,
-        // D = affC.cross(romC) and p is a point on the line
+        // D = affC.cross(romC) and p is the point of the line closest to the origin,
+        // which exists whatever the direction of the line
         Eigen::Vector3d D = affC.cross(romC);
-        D.normalize ();
-        // if the intersection line is horizontal (either of the triangles
-        // has a normal with only a Z component), the Z component cannot be arbitrarily
-        // set to 0 to find a point on the line.
-        if (fabs (D[2]) < 1e-6) {
-           if (affC.block<2,1>(0,0).isZero(1e-6)) {
-               Z = -affC3/affC[2];
-               Y = 0.0; // take Y as 0 arbitrarily
-               X = ((affC[2]-romC[2])*Z - romC[1]*Y + affC3 - romC3)/romC[0];
-           } else if (romC.block<2,1>(0,0).isZero(1e-6)) {
-               Z = -romC3/romC[2];
-               Y = 0.0;
-               X = ((romC[2]-affC[2])*Z - affC[1]*Y + romC3 - affC3)/affC[0];
-           } else if (fabs (affC[1]) < 1e-6 && fabs (romC[1]) < 1e-6) { // D only in Y-direction
-              Y = 0.0;
-              X = (romC3 -affC3*(romC[2]/affC[2]))/(affC[0]*(romC[2]/affC[2]) -romC[0]);
-              Z = (-affC[0]*X -affC3)/affC[2];
-           } else {  // D only in X
-              X = 0.0;
-              Y = (romC3 -affC3*(romC[2]/affC[2]))/(affC[1]*(romC[2]/affC[2]) -romC[1]);
-              Z = (-affC[1]*Y -affC3)/affC[2];
-           }
-        } else {
-            Z = 0.0;
-            if (fabs (affC[0]) < 1e-6) {
-                X = ((affC[2]*romC[1] -romC[2]*affC[1])*Z +
-                  affC3*romC[1] - romC3*affC[1])/ (romC[0]*affC[1] - affC[0]*romC[1]);
-                Y = (-affC[0]*X -affC[2]*Z -affC3)/affC[1];
-            } else {
-                Y = ((affC[2]*romC[0] -romC[2]*affC[0])*Z +
-                  affC3*romC[0] - romC3*affC[0])/ (romC[1]*affC[0] - affC[1]*romC[0]);
-                X = (-affC[1]*Y - affC[2]*Z - affC3)/ affC[0];
-            }
+        const double norm2 (D.squaredNorm ());
+        if (norm2 == 0.) {
+            return res;
         }
-        // point on intersecting line
-        Eigen::Vector3d p(X,Y,Z);
+        const Eigen::Vector3d p ((romC3 * affC - affC3 * romC).cross (D) / norm2);
+        D /= std::sqrt (norm2);
  
-       // Now find scalar interval along L that represents the intersection
-       // between affordance Triangle and L
-       Eigen::Vector3d projected;
-       Eigen::Vector3d dist;
-       projected[0] = (D.dot((aff.p1-p)));
-       dist[0] = a2r[0];
-       if (boost::math::sign (a2r[0]) == boost::math::sign(a2r[1])) {
-          projected[0] = (D.dot((aff.p1-p)));
-          dist[0] = a2r[0];
-          projected[1] = (D.dot((aff.p3-p))); // different sign
-          projected[2] = (D.dot((aff.p2-p)));
-          dist[1] = a2r[2];
-          dist[2] = a2r[1];
-       } else if (boost::math::sign (a2r[0]) == boost::math::sign(a2r[2])) {
-          projected[0] = (D.dot((aff.p1-p)));
-          dist[0] = a2r[0];
-          projected[1] = (D.dot((aff.p2-p))); // different sign
-          projected[2] = (D.dot((aff.p3-p)));
-          dist[1] = a2r[1];
-          dist[2] = a2r[2];
-       } else {
-          projected[0] = (D.dot((aff.p2-p)));
-          dist[0] = a2r[1];
-          projected[1] = (D.dot((aff.p1-p))); // different sign
-          projected[2] = (D.dot((aff.p3-p)));
-          dist[1] = a2r[0];
-          dist[2] = a2r[2];
-       }        
-
-        Eigen::Vector2d afft;
-        afft[0] = projected[0] + (projected[1] -projected[0])*(dist[0])/(dist[0]-dist[1]);
-        afft[1] = projected[1] + (projected[2] -projected[1])*(dist[1])/(dist[1]-dist[2]);
-
-       // same for rom triangle:
-       projected.setZero();
-       dist.setZero();
-
-       // rearrange points so that projected[1] is the point on the other side of the line
-       if (boost::math::sign (r2a[0]) == boost::math::sign(r2a[1])) {
-          projected[0] = (D.dot((rom.p1-p)));
-          dist[0] = r2a[0];
-          projected[1] = (D.dot((rom.p3-p))); // different sign
-          projected[2] = (D.dot((rom.p2-p)));
-          dist[1] = r2a[2];
-          dist[2] = r2a[1];
-       } else if (boost::math::sign (r2a[0]) == boost::math::sign(r2a[2])) {
-          projected[0] = (D.dot((rom.p1-p)));
-          dist[0] = r2a[0];
-          projected[1] = (D.dot((rom.p2-p))); // different sign
-          projected[2] = (D.dot((rom.p3-p)));
-          dist[1] = r2a[1];
-          dist[2] = r2a[2];
-       } else {
-          projected[0] = (D.dot((rom.p2-p)));
-          dist[0] = r2a[1];
-          projected[1] = (D.dot((rom.p1-p))); // different sign
-          projected[2] = (D.dot((rom.p3-p)));
-          dist[1] = r2a[0];
-          dist[2] = r2a[2];
-       }
-       Eigen::Vector2d romt;
-       romt[0] = projected[0] + (projected[1] -projected[0])*(dist[0])/(dist[0]-dist[1]);
-       romt[1] = projected[1] + (projected[2] -projected[1])*(dist[1])/(dist[1]-dist[2]);
-       
-        if ((std::min(afft[0], afft[1]) < std::max (romt[0], romt[1])) && 
-                (std::min (afft[0], afft[1]) > std::min (romt[0], romt[1])) ||
-                (std::min (romt[0], romt[1]) < std::max (afft[0], afft[1])) &&
-                (std::min (romt[0], romt[1]) > std::min (afft[0], afft[1]))) {
-            double t1 = std::max (std::min (afft[0], afft[1]), std::min (romt[0], romt[1]));
-            double t2 = std::min (std::max (afft[0], afft[1]), std::max (romt[0], romt[1]));
-            res.push_back(p + D*(t1));
-            res.push_back(p + D*(t2));
+       // Now find scalar intervals along L that represent the intersection
+       // between each triangle and L
+       const double affProj[3] = {D.dot (aff.p1-p), D.dot (aff.p2-p), D.dot (aff.p3-p)};
+       const double affDist[3] = {a2r[0], a2r[1], a2r[2]};
+       const double romProj[3] = {D.dot (rom.p1-p), D.dot (rom.p2-p), D.dot (rom.p3-p)};
+       const double romDist[3] = {r2a[0], r2a[1], r2a[2]};
+       double affMin, affMax, romMin, romMax;
+       lineInterval (affProj, affDist, affMin, affMax);
+       lineInterval (romProj, romDist, romMin, romMax);
+
+        // the triangles intersect if the start of one interval lies strictly inside the other
+        const bool overlap = ((affMin < romMax) & (affMin > romMin)) |
+            ((romMin < affMax) & (romMin > affMin));
+        if (overlap) {
+            res.points[0] = p + D*(std::max (affMin, romMin));
+            res.points[1] = p + D*(std::min (affMax, romMax));
+            res.size = 2;
         }
         return res;
         }
 
+        // Same as above, computing the signed distances.
+        TriangleSegment TriangleIntersection (const TrianglePoints& rom, const Eigen::Vector3d& romC,
+                const double romC3, const TrianglePoints& aff, const Eigen::Vector3d& affC,
+                const double affC3)
+        {
+          const Eigen::Vector3d a2r (romC.dot(aff.p1) + romC3, romC.dot(aff.p2) + romC3,
+                  romC.dot(aff.p3) + romC3);
+          const Eigen::Vector3d r2a (affC.dot(rom.p1) + affC3, affC.dot(rom.p2) + affC3,
+                  affC.dot(rom.p3) + affC3);
+          return TriangleIntersection (rom, romC, romC3, aff, affC, affC3, a2r, r2a);
+        }
+
+        // Same as above, computing the planes of both triangles.
+        TriangleSegment TriangleIntersection (const TrianglePoints& rom, const TrianglePoints& aff)
+        {
+          const Eigen::Vector3d romC ((rom.p2 - rom.p1).cross (rom.p3 - rom.p1));
+          const Eigen::Vector3d affC ((aff.p2 - aff.p1).cross (aff.p3 - aff.p1));
+          return TriangleIntersection (rom, romC, (-romC).dot (rom.p1), aff, affC, (-affC).dot (aff.p1));
+        }
+
         Inequality fcl2inequalities (const fcl::CollisionObjectPtr_t& rom)
         {
-          BVHModelOBConst_Ptr_t romModel (GetModel (rom));
-          Eigen::MatrixXd A(romModel->num_tris, 3);
-          Eigen::VectorXd b(romModel->num_tris);
-          Eigen::MatrixXd N(romModel->num_tris, 3);
-          Eigen::MatrixXd V = Eigen::MatrixXd::Ones(romModel->num_tris, 4);
-
-          TrianglePoints tri; // to save world position of vertices in matrix form
-          Eigen::Matrix3d vertexNormals; // vertex normals are equal to triangle normal in this case
-          for (unsigned int k = 0; k < romModel->num_tris; ++k) {
-              fcl::Triangle fcltri = romModel->tri_indices[k]; 
-              tri.p1 = rom->getRotation() * romModel->vertices[fcltri[0]] + rom->getTranslation(),
-              tri.p2 = rom->getRotation() * romModel->vertices[fcltri[1]] + rom->getTranslation(),
-              tri.p3 = rom->getRotation() * romModel->vertices[fcltri[2]] + rom->getTranslation();
+          std::vector<TrianglePoints> romTris; // triangles in world frame
+          getWorldTriangles (rom, romTris);
+          const Eigen::MatrixXd empty;
+          Inequality ineq (empty, Eigen::VectorXd (), empty, empty);
+          convexHullInequalities (romTris, ineq);
+          return ineq;
+        }
+
+        // Fill ineq with the facets of the convex hull of points. Returns false, leaving
+        // ineq unchanged, if the points do not span a volume. Throws if no consistent
+        // hull is found.
+        bool hullInequalities (const std::vector<Eigen::Vector3d>& points, Inequality& ineq)
+        {
+          double scale = 1.;
+          for (std::size_t i = 0; i < points.size (); ++i) {
+              scale = std::max (scale, points[i].cwiseAbs ().maxCoeff ());
+          }
+          std::vector<HullPlane> planes;
+          // rounding errors on nearly coplanar points can break the hull: a larger
+          // tolerance merges these points into the facets
+          HullStatus status (HULL_NOT_MANIFOLD);
+          double tolerance (1e-9 * scale);
+          for (int attempt = 0; attempt < 4 && status == HULL_NOT_MANIFOLD; ++attempt) {
+              status = quickHull (points, tolerance, planes);
+              tolerance *= 10.;
+          }
+          if (status == HULL_FLAT) {
+              return false;
+          }
+          if (status == HULL_NOT_MANIFOLD) {
+              std::ostringstream oss
+                ("intersect::hullInequalities: Could not build a consistent convex hull of the points.");
+              throw std::runtime_error (oss.str ());
+          }
+          const std::size_t nPlanes = planes.size ();
+          ineq.A_.resize (nPlanes, 3);
+          ineq.b_.resize (nPlanes);
+          ineq.N_.resize (nPlanes, 3);
+          ineq.V_.resize (nPlanes, 4);
+          ineq.V_.col (3).setOnes ();
+          for (std::size_t k = 0; k < nPlanes; ++k) {
+              ineq.A_.row (k) = planes[k].normal_.transpose ();
+              ineq.b_(k) = planes[k].offset_;
+              ineq.N_.row (k) = planes[k].normal_.transpose ();
+              ineq.V_.block (k,0, 1,3) = planes[k].point_.transpose ();
+          }
+          return true;
+        }
+
+        void convexHullInequalities (const std::vector<TrianglePoints>& triangles, Inequality& ineq)
+        {
+          // a corner is shared by several triangles: each point is given once to the hull
+          std::vector<Eigen::Vector3d> points;
+          points.reserve (3 * triangles.size ());
+          for (std::size_t k = 0; k < triangles.size (); ++k) {
+              points.push_back (Eigen::Vector3d (triangles[k].p1));
+              points.push_back (Eigen::Vector3d (triangles[k].p2));
+              points.push_back (Eigen::Vector3d (triangles[k].p3));
+          }
+          std::sort (points.begin (), points.end (), geom::lexicographicLess<3, const Eigen::Vector3d&>);
+          points.erase (std::unique (points.begin (), points.end ()), points.end ());
+          if (!hullInequalities (points, ineq)) {
+              // flat object: no volume to bound
+              fcl2inequalities (triangles, ineq);
+          }
+        }
+
+        void convexHullInequalities (const WeldedMesh& mesh, Inequality& ineq)
+        {
+          if (!hullInequalities (mesh.vertices_, ineq)) {
+              // flat object: no volume to bound
+              std::vector<Eigen::Vector3d> vertices;
+              std::vector<TrianglePoints> triangles;
+              getTriangles (mesh, fcl::Transform3f (), vertices, triangles);
+              fcl2inequalities (triangles, ineq);
+          }
+        }
+
+        Inequality fcl2inequalities (const std::vector<TrianglePoints>& triangles)
+        {
+          const Eigen::MatrixXd empty;
+          Inequality ineq (empty, Eigen::VectorXd (), empty, empty);
+          fcl2inequalities (triangles, ineq);
+          return ineq;
+        }
+
+        void fcl2inequalities (const std::vector<TrianglePoints>& triangles, Inequality& ineq)
+        {
+          const size_t nTris = triangles.size ();
+          // resizing to the current size keeps the storage of the matrices
+          Eigen::MatrixXd& A = ineq.A_;
+          Eigen::VectorXd& b = ineq.b_;
+          Eigen::MatrixXd& N = ineq.N_;
+          Eigen::MatrixXd& V = ineq.V_;
+          A.resize (nTris, 3);
+          b.resize (nTris);
+          N.resize (nTris, 3);
+          V.resize (nTris, 4);
+          V.col (3).setOnes ();
+
+          // vertex normals are equal to triangle normal in this case
+          for (unsigned int k = 0; k < nTris; ++k) {
+              const TrianglePoints& tri = triangles[k];
               Eigen::Vector3d normal = (tri.p2 - tri.p1).cross (tri.p3 - tri.p1);
 
               A.block(k,0, 1,3) = normal.transpose ();
@@ -451,108 +585,746 @@ namespace hpp {
               V.block(k,0, 1,3) = (Eigen::Vector3d (tri.p1)).transpose ();
               N.block(k,0, 1,3) = normal.transpose ();
           }
-
-          Inequality ineq (A,b,N,V);
-          return ineq;
         }
 
         bool is_inside (const Inequality& ineq, const Eigen::Vector3d point)
         {
-          // TODO: more efficient way of testing the inequality? No loops.
-          Eigen::VectorXd eq = ineq.A_ * point - ineq.b_;
-          for (unsigned int k = 0; k <eq.size (); ++k) {
-            if (eq(k) > 0.0) {
+          // row by row: no temporary vector is allocated for A*point - b
+          for (unsigned int k = 0; k < ineq.b_.size (); ++k) {
+            if (ineq.A_.row (k).dot (point) - ineq.b_(k) > 0.0) {
               return false;
             }
           }
           return true;
         }
 
-        // custom funciton to get intersection points: not optimal time. 
-        std::vector<Eigen::Vector3d> getIntersectionPoints (const fcl::CollisionObjectPtr_t& rom,
-               const fcl::CollisionObjectPtr_t& affordance)
+        void is_inside (const Inequality& ineq, const Eigen::Matrix3Xd& points,
+                std::vector<std::size_t>& inside)
         {
-          std::vector<Eigen::Vector3d> res;
-          res.clear ();
-          BVHModelOBConst_Ptr_t romModel (GetModel (rom));
-          BVHModelOBConst_Ptr_t affModel (GetModel (affordance));
+          inside.clear ();
+          PointBlock_t block;
+          int ids[INSIDE_BLOCK_SIZE];
+          const std::size_t nCols ((std::size_t) points.cols ());
+          for (std::size_t first = 0; first < nCols; first += INSIDE_BLOCK_SIZE) {
+              const int nPoints ((int) std::min<std::size_t> (INSIDE_BLOCK_SIZE, nCols - first));
+              block = points.middleCols (first, nPoints);
+              const int nInside (insideBlock (ineq, block, nPoints, ids));
+              for (int i = 0; i < nInside; ++i) {
+                  inside.push_back (first + ids[i]);
+              }
+          }
+        }
 
-          TrianglePoints tri;
-          std::vector<TrianglePoints> affTris; // triangles in world frame
-          std::vector<TrianglePoints> romTris;
-          
-          for (unsigned int k = 0; k < affModel->num_tris; ++k) {
-              fcl::Triangle fcltri = affModel->tri_indices[k];
-              tri.p1 = affordance->getRotation() * affModel->vertices[fcltri[0]] + affordance->getTranslation();
-              tri.p2 = affordance->getRotation() * affModel->vertices[fcltri[1]] + affordance->getTranslation();
-              tri.p3 = affordance->getRotation() * affModel->vertices[fcltri[2]] + affordance->getTranslation();
-
-              affTris.push_back (tri);
-          }
-          for (unsigned int k = 0; k < romModel->num_tris; ++k) {
-              fcl::Triangle fcltri = romModel->tri_indices[k];
-              tri.p1 = rom->getRotation() * romModel->vertices[fcltri[0]] + rom->getTranslation();
-              tri.p2 = rom->getRotation() * romModel->vertices[fcltri[1]] + rom->getTranslation();
-              tri.p3 = rom->getRotation() * romModel->vertices[fcltri[2]] + rom->getTranslation();
-
-              romTris.push_back (tri); // only save tris that could be in contact with aff
-          }
-          Inequality ineq = fcl2inequalities (rom);
-          for (unsigned int afftri = 0; afftri < affTris.size (); ++afftri) {
-              // there are a lot of cases where internal points are found but are not the end points of aff
-              // --> these are eliminated by taking the convex hull of found points.
-              if (is_inside (ineq, affTris[afftri].p1)) {
-                  res.push_back(Eigen::Vector3d(affTris[afftri].p1));
-                  }                
-              if (is_inside (ineq, affTris[afftri].p2)) {
-                  res.push_back(Eigen::Vector3d(affTris[afftri].p2));
+        // Sutherland-Hodgman clipping of a triangle, see clipTriangle
+        template <typename Planes>
+        bool clipPolygon (const Planes& planes, const TrianglePoints& triangle,
+                std::vector<Eigen::Vector3d>& polygon, std::vector<Eigen::Vector3d>& buffer)
+        {
+          polygon.clear ();
+          polygon.push_back (Eigen::Vector3d (triangle.p1));
+          polygon.push_back (Eigen::Vector3d (triangle.p2));
+          polygon.push_back (Eigen::Vector3d (triangle.p3));
+          for (std::size_t k = 0; k < planes.size (); ++k) {
+              // keep the part of the polygon where the distance to plane k is <= 0
+              buffer.clear ();
+              const std::size_t n = polygon.size ();
+              double previousDist = planes.distance (k, polygon[n-1]);
+              for (std::size_t i = 0; i < n; ++i) {
+                  const Eigen::Vector3d& previous = polygon[(i + n - 1) % n];
+                  const Eigen::Vector3d& current = polygon[i];
+                  const double dist = planes.distance (k, current);
+                  if ((dist > 0.) != (previousDist > 0.)) {
+                      // the edge crosses the plane: previousDist and dist have different signs
+                      buffer.push_back (previous + (previousDist / (previousDist - dist)) *
+                              (current - previous));
                   }
-              if (is_inside (ineq, affTris[afftri].p3)) {
-                  res.push_back(Eigen::Vector3d(affTris[afftri].p3));
+                  if (dist <= 0.) {
+                      buffer.push_back (current);
                   }
+                  previousDist = dist;
+              }
+              polygon.swap (buffer);
+              if (polygon.empty ()) {
+                  return false;
+              }
+          }
+          return true;
+        }
+
+        bool clipTriangle (const Inequality& ineq, const TrianglePoints& triangle,
+                std::vector<Eigen::Vector3d>& polygon, std::vector<Eigen::Vector3d>& buffer)
+        {
+          return clipPolygon (InequalityPlanes (ineq), triangle, polygon, buffer);
+        }
+
+        // Collect the vertices of the polygons obtained by clipping the triangles
+        // affTris[begin, end) against the planes of the rom placed at romTf. Triangles
+        // whose bounding box does not meet the box [romMin, romMax] around the rom, and
+        // degenerate triangles, are skipped; triangles inside the inscribed sphere of the
+        // rom are kept whole. The triangles are clipped in the frame of the rom.
+        void clipTriangles (const Polytope& rom, const fcl::Transform3f& romTf,
+                const std::vector<TrianglePoints>& affTris,
+                const std::vector<bool>& degenerate, const Eigen::Vector3d& romMin,
+                const Eigen::Vector3d& romMax, const std::size_t begin, const std::size_t end,
+                std::vector<Eigen::Vector3d>& polygon, std::vector<Eigen::Vector3d>& buffer,
+                std::vector<Eigen::Vector3d>& res)
+        {
+          const double inner2 (rom.innerRadius () < 0. ? -1. :
+                  rom.innerRadius () * rom.innerRadius ());
+          const fcl::Matrix3f rotT (romTf.getRotation ().transpose ());
+          const fcl::Vec3f translation (romTf.getTranslation ());
+          TrianglePoints romTri;
+          for (std::size_t afftri = begin; afftri < end; ++afftri) {
+              if (degenerate[afftri]) {
+                  continue;
+              }
+              const Eigen::Vector3d p1 (affTris[afftri].p1), p2 (affTris[afftri].p2),
+                    p3 (affTris[afftri].p3);
+              if ((p1.cwiseMax (p2).cwiseMax (p3).array () < romMin.array ()).any () ||
+                      (p1.cwiseMin (p2).cwiseMin (p3).array () > romMax.array ()).any ()) {
+                  continue;
+              }
+              romTri.p1 = rotT * (p1 - translation);
+              romTri.p2 = rotT * (p2 - translation);
+              romTri.p3 = rotT * (p3 - translation);
+              if ((Eigen::Vector3d (romTri.p1) - rom.center ()).squaredNorm () <= inner2 &&
+                      (Eigen::Vector3d (romTri.p2) - rom.center ()).squaredNorm () <= inner2 &&
+                      (Eigen::Vector3d (romTri.p3) - rom.center ()).squaredNorm () <= inner2) {
+                  res.push_back (p1);
+                  res.push_back (p2);
+                  res.push_back (p3);
+                  continue;
+              }
+              if (clipPolygon (rom, romTri, polygon, buffer)) {
+                  for (std::size_t i = 0; i < polygon.size (); ++i) {
+                      res.push_back (romTf.getRotation () * polygon[i] + romTf.getTranslation ());
+                  }
+              }
           }
-          // Check collision only after finding internal aff vertices: if the whole of aff
-          // is within the ROM body, no collision will be found but the whole aff area is in fact available
-          // for contact planning.
-          CollisionPair_t col = CollisionPair_t (affordance, rom);
-          fcl::CollisionRequest req;
-          req.enable_contact = true;
-          fcl::CollisionResult result;
-          fcl::collide (col.first.get (), col.second.get (), req, result);
-          if (!result.isCollision () && res.size () == 0) {
-              std::cout << "ROM and affordance object not in collision!" << std::endl;
-              res.clear ();
-              return res;
-          }
-
-          for (unsigned int afftri = 0; afftri < affTris.size (); ++afftri) {
-              for (unsigned int romtri = 0; romtri < romTris.size(); ++romtri) {
-                  // check whether affTris[afftri] and romTris[romTri] intersect.
+        }
+
+        // Collect the affordance vertices affVertices[begin, end) that are inside the rom
+        // placed at romTf. The vertices are moved to the frame of the rom and tested by
+        // blocks of INSIDE_BLOCK_SIZE, see insideBlock.
+        void insideVertices (const Polytope& rom, const fcl::Transform3f& romTf,
+                const std::vector<Eigen::Vector3d>& affVertices, const std::size_t begin,
+                const std::size_t end, std::vector<Eigen::Vector3d>& res)
+        {
+          // there are a lot of cases where internal points are found but are not the end points of aff
+          // --> these are eliminated by taking the convex hull of found points.
+          const fcl::Matrix3f rotT (romTf.getRotation ().transpose ());
+          const fcl::Vec3f translation (romTf.getTranslation ());
+          PointBlock_t block;
+          int ids[INSIDE_BLOCK_SIZE];
+          for (std::size_t first = begin; first < end; first += INSIDE_BLOCK_SIZE) {
+              const int nPoints ((int) std::min<std::size_t> (INSIDE_BLOCK_SIZE, end - first));
+              block.resize (3, nPoints);
+              for (int i = 0; i < nPoints; ++i) {
+                  block.col (i).noalias () = rotT * (affVertices[first + i] - translation);
+              }
+              const int nInside (insideBlock (rom, block, nPoints, ids));
+              for (int i = 0; i < nInside; ++i) {
+                  res.push_back (affVertices[first + ids[i]]);
+              }
+          }
+        }
+
+        // Compute the intersection segments of the candidate pairs candidates[begin, end).
+        // Pairs are processed in tiles: the signed distances between the vertices and the
+        // planes of all pairs of a tile are computed at once, and their sign patterns are
+        // tested by blocks of pairs, see DistanceTile. Only the pairs that show no separating
+        // plane go through the full intersection test.
+        // The planes of the triangles are read from romPlanes and affPlanes.
+        void intersectCandidates (const WeldedMesh& romMesh, const std::vector<TrianglePoints>& romTris,
+                const Inequality& romPlanes, const WeldedMesh& affMesh,
+                const std::vector<TrianglePoints>& affTris, const Inequality& affPlanes,
+                const std::vector<std::pair<int, int> >& candidates, const std::size_t begin,
+                const std::size_t end, DistanceTile& tile, std::vector<Eigen::Vector3d>& res)
+        {
+          Eigen::Vector3d romC, affC, a2r, r2a;
+          double romC3, affC3;
+          for (std::size_t first = begin; first < end; first += DISTANCE_TILE_SIZE) {
+              const std::size_t last = std::min (first + DISTANCE_TILE_SIZE, end);
+              tile.set (romMesh, romTris, romPlanes, affMesh, affTris, affPlanes,
+                      &candidates[first], &candidates[0] + last);
+              for (std::size_t k = first; k < last; ++k) {
+                  if (!tile.overlaps ((unsigned int) (k - first))) {
+                      continue;
+                  }
+                  tile.distances ((unsigned int) (k - first), a2r, r2a);
+                  // check whether the candidate triangles intersect.
                   // If yes, find intersection line
-                  std::vector<Eigen::Vector3d> points = TriangleIntersection (romTris[romtri],
-                          affTris[afftri]);
-                  res.insert(res.end(), points.begin(), points.end());
+                  const int afftri = candidates[k].first;
+                  const int romtri = candidates[k].second;
+                  trianglePlane (romPlanes, romtri, romC, romC3);
+                  trianglePlane (affPlanes, afftri, affC, affC3);
+                  const TriangleSegment segment = TriangleIntersection (romTris[romtri],
+                          romC, romC3, affTris[afftri], affC, affC3, a2r, r2a);
+                  res.insert (res.end (), segment.points, segment.points + segment.size);
               }
           }
-         // After finding points, create convex hull and refine to get more points for ellipse approximation
-         std::vector<Eigen::Vector3d> hull = geom::convexHull<std::vector<Eigen::Vector3d> >(res.begin(), res.end());
-         if (hull.size () > 2) {
-            double minDist = 0.1; //10 cm minimum interval TODO: hard-coded or user-given value?
-            for (unsigned int k = 0; k < hull.size () -1; ++k) {
-                     if (minDist > (hull[k+1] - hull[k]).norm () && (hull[k+1] - hull[k]).norm () > 0.01) {
-                  minDist = (hull[k+1] - hull[k]).norm ();
-                }
-            }
-            std::vector<Eigen::Vector3d> hullRefined;
-            for (unsigned int j = 0; j < hull.size () -1; ++j) {
-                double intervals = std::ceil (((hull[j+1] - hull[j]).norm ())/minDist);
-                for (unsigned int i = 0; i < (unsigned int) intervals; ++i) {
-                    hullRefined.push_back (hull[j] + (i+1)*(hull[j+1]-hull[j])/intervals);
-            }
+        }
+
+        // first element of chunk k when n elements are split in nChunks chunks
+        std::size_t chunkBegin (const std::size_t n, const unsigned int k, const unsigned int nChunks)
+        {
+          return (n * k) / nChunks;
+        }
+
+        // inside test of one chunk of affordance vertices
+        struct InsideChunk
+        {
+          InsideChunk (const Polytope& rom, const fcl::Transform3f& romTf,
+                  const std::vector<Eigen::Vector3d>& affVertices, const unsigned int nChunks,
+                  std::vector<std::vector<Eigen::Vector3d> >& res):
+              rom_ (rom), romTf_ (romTf), affVertices_ (affVertices), nChunks_ (nChunks),
+              res_ (res) {}
+          void operator () (const unsigned int k) const
+          {
+            insideVertices (rom_, romTf_, affVertices_, chunkBegin (affVertices_.size (), k, nChunks_),
+                    chunkBegin (affVertices_.size (), k+1, nChunks_), res_[k]);
+          }
+          const Polytope& rom_;
+          const fcl::Transform3f& romTf_;
+          const std::vector<Eigen::Vector3d>& affVertices_;
+          const unsigned int nChunks_;
+          std::vector<std::vector<Eigen::Vector3d> >& res_;
+        };
+
+        // clipping of one chunk of affordance triangles against the rom planes
+        struct ClipChunk
+        {
+          ClipChunk (const Polytope& rom, const fcl::Transform3f& romTf,
+                  const std::vector<TrianglePoints>& affTris,
+                  const std::vector<bool>& degenerate, const Eigen::Vector3d& romMin,
+                  const Eigen::Vector3d& romMax, const unsigned int nChunks,
+                  std::vector<std::vector<Eigen::Vector3d> >& polygons,
+                  std::vector<std::vector<Eigen::Vector3d> >& res):
+              rom_ (rom), romTf_ (romTf), affTris_ (affTris), degenerate_ (degenerate),
+              romMin_ (romMin), romMax_ (romMax), nChunks_ (nChunks), polygons_ (polygons),
+              res_ (res) {}
+          void operator () (const unsigned int k) const
+          {
+            clipTriangles (rom_, romTf_, affTris_, degenerate_, romMin_, romMax_,
+                    chunkBegin (affTris_.size (), k, nChunks_),
+                    chunkBegin (affTris_.size (), k+1, nChunks_),
+                    polygons_[2*k], polygons_[2*k+1], res_[k]);
+          }
+          const Polytope& rom_;
+          const fcl::Transform3f& romTf_;
+          const std::vector<TrianglePoints>& affTris_;
+          const std::vector<bool>& degenerate_;
+          const Eigen::Vector3d& romMin_;
+          const Eigen::Vector3d& romMax_;
+          const unsigned int nChunks_;
+          std::vector<std::vector<Eigen::Vector3d> >& polygons_;
+          std::vector<std::vector<Eigen::Vector3d> >& res_;
+        };
+
+        // exact intersection test of one chunk of candidate triangle pairs
+        struct PairChunk
+        {
+          PairChunk (const WeldedMesh& romMesh, const std::vector<TrianglePoints>& romTris,
+                  const Inequality& romPlanes, const WeldedMesh& affMesh,
+                  const std::vector<TrianglePoints>& affTris, const Inequality& affPlanes,
+                  const std::vector<std::pair<int, int> >& candidates, const unsigned int nChunks,
+                  std::vector<boost::shared_ptr<DistanceTile> >& tiles,
+                  std::vector<std::vector<Eigen::Vector3d> >& res):
+              romMesh_ (romMesh), romTris_ (romTris), romPlanes_ (romPlanes),
+              affMesh_ (affMesh), affTris_ (affTris), affPlanes_ (affPlanes),
+              candidates_ (candidates), nChunks_ (nChunks), tiles_ (tiles), res_ (res) {}
+          void operator () (const unsigned int k) const
+          {
+            intersectCandidates (romMesh_, romTris_, romPlanes_, affMesh_, affTris_, affPlanes_,
+                    candidates_, chunkBegin (candidates_.size (), k, nChunks_),
+                    chunkBegin (candidates_.size (), k+1, nChunks_), *tiles_[k], res_[k]);
+          }
+          const WeldedMesh& romMesh_;
+          const std::vector<TrianglePoints>& romTris_;
+          const Inequality& romPlanes_;
+          const WeldedMesh& affMesh_;
+          const std::vector<TrianglePoints>& affTris_;
+          const Inequality& affPlanes_;
+          const std::vector<std::pair<int, int> >& candidates_;
+          const unsigned int nChunks_;
+          std::vector<boost::shared_ptr<DistanceTile> >& tiles_;
+          std::vector<std::vector<Eigen::Vector3d> >& res_;
+        };
+
+        // run all chunks, on the thread pool if there is more than one
+        template <typename Chunk>
+        void runChunks (const unsigned int nChunks, const Chunk& chunk)
+        {
+          if (nChunks == 1) {
+              chunk (0);
+          } else {
+              ThreadPool::instance ().run (nChunks, chunk);
+          }
+        }
+
+        // append the chunk buffers to res in chunk order and empty them
+        void mergeChunks (std::vector<std::vector<Eigen::Vector3d> >& partial,
+                std::vector<Eigen::Vector3d>& res)
+        {
+          for (std::size_t k = 0; k < partial.size (); ++k) {
+              res.insert (res.end (), partial[k].begin (), partial[k].end ());
+              partial[k].clear ();
+          }
+        }
+
+        // Large queries are split in chunks of affordance triangles (resp. candidate
+        // pairs) that run on the thread pool, each chunk filling its own buffer.
+        unsigned int numChunks (const IntersectionRequest& request, const std::size_t nTriangles)
+        {
+          if (request.numThreads_ == 1 || nTriangles < request.parallelThreshold_) {
+              return 1;
+          }
+          return request.numThreads_ > 0 ? request.numThreads_ : ThreadPool::instance ().size () + 1;
+        }
+
+        // custom funciton to get intersection points: not optimal time. 
+        std::vector<Eigen::Vector3d> getIntersectionPoints (const fcl::CollisionObjectPtr_t& rom,
+               const fcl::CollisionObjectPtr_t& affordance, const IntersectionRequest& request)
+        {
+          MeshCache cache;
+          return getIntersectionPoints (rom, affordance, cache, request);
+        }
+
+        // Rotation and translation of pose expressed in frame.
+        void relativeTransform (const fcl::Transform3f& frame, const fcl::Transform3f& pose,
+                fcl::Matrix3f& R, fcl::Vec3f& T)
+        {
+          const fcl::Matrix3f frameRotT (frame.getRotation ().transpose ());
+          R = frameRotT * pose.getRotation ();
+          T = frameRotT * (pose.getTranslation () - frame.getTranslation ());
+        }
+
+        // Collect the welded indices of the vertices of the affordance triangles whose
+        // bounding volume is closer than margin to the root bounding volume of the rom,
+        // which contains the convex hull of the rom. R and T place the rom in the
+        // affordance model frame. The indices are sorted and unique.
+        void collectNearVertices (const BVHModelOB& affModel, const WeldedMesh& affMesh,
+                const BVHModelOB& romModel, const fcl::Matrix3f& R, const fcl::Vec3f& T,
+                const double margin, std::vector<int>& vertices,
+                std::vector<std::pair<int, int> >& stack)
+        {
+          vertices.clear ();
+          stack.clear ();
+          if (affModel.getNumBVs () == 0 || romModel.getNumBVs () == 0) {
+              return;
+          }
+          const fcl::OBBRSS& romBV = romModel.getBV (0).bv;
+          stack.push_back (std::make_pair (0, 0));
+          while (!stack.empty ()) {
+              const fcl::BVNode<fcl::OBBRSS>& affNode = affModel.getBV (stack.back ().first);
+              stack.pop_back ();
+              if (!fcl::overlap (R, T, affNode.bv, romBV) &&
+                      fcl::distance (R, T, affNode.bv, romBV) > margin) {
+                  continue;
+              }
+              if (affNode.isLeaf ()) {
+                  const int afftri = affNode.primitiveId ();
+                  vertices.insert (vertices.end (), &affMesh.indices_[3 * afftri],
+                          &affMesh.indices_[3 * afftri] + 3);
+                  continue;
+              }
+              stack.push_back (std::make_pair (affNode.leftChild (), 0));
+              stack.push_back (std::make_pair (affNode.rightChild (), 0));
+          }
+          std::sort (vertices.begin (), vertices.end ());
+          vertices.erase (std::unique (vertices.begin (), vertices.end ()), vertices.end ());
+        }
+
+        // Remove the candidate pairs with a degenerate triangle, which add no contact
+        // point of their own, and sort the others by rom triangle: the pairs sharing
+        // vertices and planes then fall in the same distance tiles.
+        void selectCandidates (const WeldedMesh& affMesh, const WeldedMesh& romMesh,
+                std::vector<std::pair<int, int> >& candidates)
+        {
+          std::size_t nCandidates = 0;
+          for (std::size_t k = 0; k < candidates.size (); ++k) {
+              if (!affMesh.degenerate_[candidates[k].first] &&
+                      !romMesh.degenerate_[candidates[k].second]) {
+                  candidates[nCandidates++] = candidates[k];
+              }
+          }
+          candidates.resize (nCandidates);
+          std::sort (candidates.begin (), candidates.end (), romTriangleLess);
+        }
+
+        // Collect the contact points between rom and affordance: the affordance vertices
+        // inside the rom and the intersection segments of their triangles. All data are
+        // expressed in one common frame: romTf and affTf place the models in that frame,
+        // and romTris, ineq, affVertices, affTris, affPlanes and the returned
+        // points are expressed in it. romMesh and affMesh give the welded vertex indices
+        // of the triangles, and affVertices the unique affordance vertices, each tested
+        // once. ineq gives the planes of the rom triangles, affPlanes those of
+        // the affordance triangles, and rom the convex hull of the rom compiled for the
+        // inside tests, in the rom model frame: the points are moved to that frame with
+        // romTf, so that the hull never changes with the pose. Returns false if the objects are not in contact.
+        // Intermediate results are kept in the buffers of workspace. If context is not NULL,
+        // the candidate pairs it kept are tested when the rom moved little since they were
+        // collected, see QueryContext.
+        bool contactPoints (const BVHModelOB& romModel, const WeldedMesh& romMesh,
+               const fcl::Transform3f& romTf, const std::vector<TrianglePoints>& romTris,
+               const Inequality& ineq, const Polytope& rom, const BVHModelOB& affModel,
+               const WeldedMesh& affMesh, const fcl::Transform3f& affTf,
+               const std::vector<Eigen::Vector3d>& affVertices,
+               const std::vector<TrianglePoints>& affTris, const Inequality& affPlanes,
+               const IntersectionRequest& request, IntersectionWorkspace& workspace,
+               QueryContext* context, std::vector<Eigen::Vector3d>& res)
+        {
+          res.clear ();
+          const unsigned int nChunks (numChunks (request, affTris.size ()));
+          std::vector<std::vector<Eigen::Vector3d> >& partial = workspace.partial_;
+          partial.resize (nChunks);
+          std::vector<std::pair<int, int> >& candidates = workspace.candidates_;
+          const std::vector<std::pair<int, int> >* pairs = &candidates;
+          const std::vector<Eigen::Vector3d>* vertices = &affVertices;
+          fcl::Matrix3f relR;
+          fcl::Vec3f relT;
+          relativeTransform (affTf, romTf, relR, relT);
+          if (context != NULL) {
+              // the pairs closer than the margin of the context contain all pairs that
+              // may intersect, and the affordance vertices close to the bounding volume of
+              // the rom all those that may be inside it, until the rom has moved by more
+              // than the margin: they are only collected again after such a motion, and
+              // no collision test is needed.
+              if (!context->reuse (relR, relT)) {
+                  collectCandidatePairs (affModel, romModel, relR, relT, context->margin (),
+                          candidates, workspace.stack_);
+                  selectCandidates (affMesh, romMesh, candidates);
+                  collectNearVertices (affModel, affMesh, romModel, relR, relT,
+                          context->margin (), workspace.vertexIds_, workspace.stack_);
+                  context->store (relR, relT, candidates, workspace.vertexIds_);
+              }
+              pairs = &context->pairs ();
+              std::vector<Eigen::Vector3d>& nearVertices = workspace.nearVertices_;
+              nearVertices.clear ();
+              for (std::size_t i = 0; i < context->vertices ().size (); ++i) {
+                  nearVertices.push_back (affVertices[context->vertices ()[i]]);
+              }
+              vertices = &nearVertices;
+          }
+          InsideChunk insideChunk (rom, romTf, *vertices, nChunks, partial);
+          runChunks (nChunks, insideChunk);
+          mergeChunks (partial, res);
+          if (context == NULL) {
+              // Check collision only after finding internal aff vertices: if the whole of aff
+              // is within the ROM body, no collision will be found but the whole aff area is in fact available
+              // for contact planning.
+              fcl::CollisionRequest req;
+              if (request.pairSelection_ == FCL_CONTACTS) {
+                  // all contacts are needed: each one gives a candidate triangle pair
+                  req.num_max_contacts = std::numeric_limits<size_t>::max ();
+                  req.enable_contact = true;
+              }
+              fcl::CollisionResult& result = workspace.collisionResult_;
+              result.clear ();
+              fcl::collide (&affModel, affTf, &romModel, romTf, req, result);
+              if (!result.isCollision () && res.size () == 0) {
+                  std::cout << "ROM and affordance object not in collision!" << std::endl;
+                  return false;
+              }
+
+              if (request.pairSelection_ == FCL_CONTACTS) {
+                  // reuse the traversal fcl already did: contact b1 refers to a triangle
+                  // of the affordance (first object), b2 to a triangle of the rom.
+                  candidates.clear ();
+                  for (std::size_t k = 0; k < result.numContacts (); ++k) {
+                      const fcl::Contact& contact = result.getContact (k);
+                      candidates.push_back (std::make_pair (contact.b1, contact.b2));
+                  }
+              } else {
+                  // only triangle pairs with overlapping bounding volumes can intersect:
+                  // descend both BVH trees instead of testing all affTris x romTris pairs.
+                  collectCandidatePairs (affModel, romModel, relR, relT, 0., candidates,
+                          workspace.stack_);
+              }
+              selectCandidates (affMesh, romMesh, candidates);
+          }
+          std::vector<boost::shared_ptr<DistanceTile> >& tiles = workspace.tiles_;
+          while (tiles.size () < nChunks) {
+              tiles.push_back (boost::shared_ptr<DistanceTile> (new DistanceTile));
+          }
+          PairChunk pairChunk (romMesh, romTris, ineq, affMesh, affTris, affPlanes, *pairs,
+                  nChunks, tiles, partial);
+          runChunks (nChunks, pairChunk);
+          mergeChunks (partial, res);
+          return true;
+        }
+
+        // Contact points between a convex rom and an affordance with CONVEX_CLIPPING: the
+        // part of the affordance inside the rom is the union of the clipped triangles, whose
+        // vertices replace both the inside vertices and the intersection segments.
+        // The data are expressed in a common frame as in contactPoints; only the affordance
+        // triangles and the rom polytope are read, and the box around the rom is obtained
+        // from the bounds of its welded mesh. Returns false if the objects are not in contact.
+        bool clipContactPoints (const WeldedMesh& romMesh, const fcl::Transform3f& romTf,
+               const Polytope& rom, const WeldedMesh& affMesh,
+               const std::vector<TrianglePoints>& affTris, const IntersectionRequest& request,
+               IntersectionWorkspace& workspace, std::vector<Eigen::Vector3d>& res)
+        {
+          res.clear ();
+          if (romMesh.radius_ < 0.) {
+              return false;
+          }
+          // a rotated box is contained in the box whose half extents are |R| times its own
+          const Eigen::Vector3d romHalf (romTf.getRotation ().cwiseAbs () *
+                  (.5 * (romMesh.max_ - romMesh.min_)));
+          const Eigen::Vector3d romCenter (romTf.transform (romMesh.center_));
+          const Eigen::Vector3d romMin (romCenter - romHalf), romMax (romCenter + romHalf);
+          const unsigned int nChunks (numChunks (request, affTris.size ()));
+          std::vector<std::vector<Eigen::Vector3d> >& partial = workspace.partial_;
+          partial.resize (nChunks);
+          workspace.polygons_.resize (2 * nChunks);
+          ClipChunk clipChunk (rom, romTf, affTris, affMesh.degenerate_, romMin, romMax, nChunks,
+                  workspace.polygons_, partial);
+          runChunks (nChunks, clipChunk);
+          mergeChunks (partial, res);
+          return !res.empty ();
+        }
+
+        // Contact region from contact points given in world frame: convex hull of
+        // the points, resampled to get points for ellipse approximation. The hull
+        // is computed in the hull buffer and the region written to region.
+        void contactRegion (const std::vector<Eigen::Vector3d>& res,
+                const IntersectionRequest& request,
+                std::vector<Eigen::Vector3d>& hull, std::vector<Eigen::Vector3d>& region)
+        {
+         region.clear ();
+         if (res.empty ()) {
+             return;
          }
-         res = hullRefined;
+         geom::monotoneChainHull<std::vector<Eigen::Vector3d> >(res.begin(), res.end(), hull);
+         if (hull.size () > 2) {
+            resampleHull (hull, request.maxRegionSpacing_, request.maxRegionPoints_, region);
+            return;
          }
-          return res; 
+          region = res;
+        }
+
+        // Conservative test on the root bounding volumes of two models, which reads no
+        // triangle and computes no mesh data: returns false if a model has no vertex, or
+        // if the root OBBRSS of the models at their poses are disjoint. Models without
+        // hierarchy cannot be rejected.
+        bool boundsOverlap (const BVHModelOB& romModel, const fcl::Transform3f& romPose,
+                const BVHModelOB& affModel, const fcl::Transform3f& affPose)
+        {
+          if (romModel.num_vertices == 0 || affModel.num_vertices == 0) {
+              return false;
+          }
+          if (romModel.getNumBVs () == 0 || affModel.getNumBVs () == 0) {
+              return true;
+          }
+          // pose of the rom in the affordance model frame
+          fcl::Matrix3f R;
+          fcl::Vec3f T;
+          relativeTransform (affPose, romPose, R, T);
+          return fcl::overlap (R, T, affModel.getBV (0).bv, romModel.getBV (0).bv);
+        }
+
+        // Contact region between a rom model at romPose and an affordance model at affPose.
+        // The test is invariant under a rigid motion applied to both models: it is done in
+        // the model frame of the mesh with more triangles, whose cached data stay constant,
+        // and only the vertices of the smaller mesh are transformed. The planes of the
+        // triangles are computed once per triangle, with the triangles of each mesh,
+        // before any pair is tested. The contact points are
+        // mapped back to world frame before building the contact region, which is
+        // returned in the region buffer of workspace. Models whose bounds are disjoint
+        // are rejected first, see boundsOverlap, then pairs still separated by the plane
+        // kept by the cache when they were last found not in contact, see
+        // MeshCache::separated. context may be NULL, see contactPoints.
+        const std::vector<Eigen::Vector3d>& intersectInModelFrame (const BVHModelOBConst_Ptr_t& romModel,
+               const fcl::Transform3f& romPose, const BVHModelOBConst_Ptr_t& affModel,
+               const fcl::Transform3f& affPose, MeshCache& cache, IntersectionWorkspace& workspace,
+               QueryContext* context, const IntersectionRequest& request)
+        {
+          // most affordances tried by a planner are out of reach of the rom:
+          // leave before any mesh is welded or any triangle is read
+          if (!boundsOverlap (*romModel, romPose, *affModel, affPose)) {
+              workspace.region_.clear ();
+              return workspace.region_;
+          }
+          const WeldedMesh& romMesh = cache.modelMesh (romModel);
+          const WeldedMesh& affMesh = cache.modelMesh (affModel);
+          // pose of the affordance in the rom model frame
+          fcl::Matrix3f affR;
+          fcl::Vec3f affT;
+          relativeTransform (romPose, affPose, affR, affT);
+          if (cache.separated (romModel, affModel, affR, affT)) {
+              workspace.region_.clear ();
+              return workspace.region_;
+          }
+          if (context != NULL) {
+              context->setModels (romModel, affModel);
+          }
+          std::vector<Eigen::Vector3d>& res = workspace.points_;
+          std::vector<TrianglePoints>& movedTris = workspace.triangles_;
+          const fcl::Transform3f identity;
+          fcl::Matrix3f R;
+          fcl::Vec3f T;
+          bool contact;
+          const bool romFrame (romModel->num_tris >= affModel->num_tris);
+          const fcl::Transform3f& frame = romFrame ? romPose : affPose;
+          // clipping needs neither the triangle planes nor the rom triangles
+          const bool clipping (request.pairSelection_ == CONVEX_CLIPPING);
+          if (romFrame) {
+              relativeTransform (romPose, affPose, R, T);
+              const fcl::Transform3f affTf (R, T);
+              getTriangles (affMesh, affTf, workspace.vertices_, movedTris);
+              if (clipping) {
+                  contact = clipContactPoints (romMesh, identity, cache.modelPolytope (romModel),
+                          affMesh, movedTris, request, workspace, res);
+              } else {
+                  fcl2inequalities (movedTris, workspace.inequality_);
+                  contact = contactPoints (*romModel, romMesh, identity, cache.modelTriangles (romModel),
+                          cache.modelInequality (romModel), cache.modelPolytope (romModel),
+                          *affModel, affMesh, affTf, workspace.vertices_, movedTris,
+                          workspace.inequality_, request, workspace, context, res);
+              }
+          } else {
+              relativeTransform (affPose, romPose, R, T);
+              const fcl::Transform3f romTf (R, T);
+              if (clipping) {
+                  contact = clipContactPoints (romMesh, romTf, cache.modelPolytope (romModel),
+                          affMesh, cache.modelTriangles (affModel), request, workspace, res);
+              } else {
+                  getTriangles (romMesh, romTf, workspace.vertices_, movedTris);
+                  fcl2inequalities (movedTris, workspace.inequality_);
+                  contact = contactPoints (*romModel, romMesh, romTf, movedTris, workspace.inequality_,
+                          cache.modelPolytope (romModel), *affModel, affMesh, identity, affMesh.vertices_,
+                          cache.modelTriangles (affModel), cache.modelInequality (affModel),
+                          request, workspace, context, res);
+              }
+          }
+          if (!contact || res.empty ()) {
+              // the next queries on the pair are rejected while the models stay apart
+              cache.findSeparation (romModel, affModel, affR, affT);
+              workspace.region_.clear ();
+              return workspace.region_;
+          }
+          // shared vertices and the ends of the segments of neighbouring triangle pairs
+          // give many (nearly) identical points: only one of each is passed to the hull
+          mergeClosePoints (res, request.mergeTolerance_, workspace.pointTable_);
+          for (std::size_t i = 0; i < res.size (); ++i) {
+              res[i] = frame.getRotation () * res[i] + frame.getTranslation ();
+          }
+          contactRegion (res, request, workspace.hull_, workspace.region_);
+          return workspace.region_;
+        }
+
+        std::vector<Eigen::Vector3d> getIntersectionPoints (const fcl::CollisionObjectPtr_t& rom,
+               const fcl::CollisionObjectPtr_t& affordance, MeshCache& cache,
+               const IntersectionRequest& request)
+        {
+          IntersectionWorkspace workspace;
+          return getIntersectionPoints (rom, affordance, cache, workspace, request);
+        }
+
+        const std::vector<Eigen::Vector3d>& getIntersectionPoints (const fcl::CollisionObjectPtr_t& rom,
+               const fcl::CollisionObjectPtr_t& affordance, MeshCache& cache,
+               IntersectionWorkspace& workspace, const IntersectionRequest& request)
+        {
+          return intersectInModelFrame (GetModel (rom), rom->getTransform (),
+                  GetModel (affordance), affordance->getTransform (), cache, workspace, NULL,
+                  request);
+        }
+
+        const std::vector<Eigen::Vector3d>& getIntersectionPoints (const fcl::CollisionObjectPtr_t& rom,
+               const fcl::CollisionObjectPtr_t& affordance, MeshCache& cache,
+               IntersectionWorkspace& workspace, QueryContext& context,
+               const IntersectionRequest& request)
+        {
+          return intersectInModelFrame (GetModel (rom), rom->getTransform (),
+                  GetModel (affordance), affordance->getTransform (), cache, workspace, &context,
+                  request);
+        }
+
+        std::vector<Eigen::Vector3d> getIntersectionPoints (const fcl::CollisionObjectPtr_t& rom,
+               const fcl::CollisionObjectPtr_t& affordance, MeshCache& cache,
+               IntersectionWorkspace& workspace, ResultCache& results,
+               const IntersectionRequest& request)
+        {
+          const BVHModelOBConst_Ptr_t romModel (GetModel (rom));
+          const BVHModelOBConst_Ptr_t affModel (GetModel (affordance));
+          std::vector<Eigen::Vector3d> region;
+          // separated objects would only fill the cache with empty regions
+          if (!boundsOverlap (*romModel, rom->getTransform (), *affModel,
+                      affordance->getTransform ())) {
+              return region;
+          }
+          if (results.find (romModel, rom->getTransform (), affModel,
+                      affordance->getTransform (), region)) {
+              return region;
+          }
+          region = intersectInModelFrame (romModel, rom->getTransform (), affModel,
+                  affordance->getTransform (), cache, workspace, NULL, request);
+          results.insert (romModel, rom->getTransform (), affModel, affordance->getTransform (),
+                  region);
+          return region;
+        }
+
+        std::vector<std::vector<Eigen::Vector3d> > getIntersectionPoints
+            (const fcl::CollisionObjectPtr_t& rom,
+             const std::vector<fcl::CollisionObjectPtr_t>& affordances,
+             const IntersectionRequest& request)
+        {
+          MeshCache cache;
+          return getIntersectionPoints (rom, affordances, cache, request);
+        }
+
+        std::vector<std::vector<Eigen::Vector3d> > getIntersectionPoints
+            (const fcl::CollisionObjectPtr_t& rom,
+             const std::vector<fcl::CollisionObjectPtr_t>& affordances, MeshCache& cache,
+             const IntersectionRequest& request)
+        {
+          std::vector<std::vector<Eigen::Vector3d> > res (affordances.size ());
+          // model frame data of the rom are prepared once for all affordances
+          BVHModelOBConst_Ptr_t romModel (GetModel (rom));
+          IntersectionWorkspace workspace;
+          fcl::Matrix3f relR;
+          fcl::Vec3f relT;
+          for (std::size_t k = 0; k < affordances.size (); ++k) {
+              // skip affordances whose root bounding volume misses the rom: no
+              // triangle can intersect and no vertex can be inside the rom. Models
+              // without hierarchy are left to the bounds test of intersectInModelFrame.
+              BVHModelOBConst_Ptr_t affModel (GetModel (affordances[k]));
+              if (romModel->getNumBVs () > 0 && affModel->getNumBVs () > 0) {
+                  relativeTransform (affordances[k]->getTransform (), rom->getTransform (),
+                          relR, relT);
+                  if (!fcl::overlap (relR, relT, affModel->getBV (0).bv, romModel->getBV (0).bv)) {
+                      continue;
+                  }
+              }
+              res[k] = intersectInModelFrame (romModel, rom->getTransform (), affModel,
+                      affordances[k]->getTransform (), cache, workspace, NULL, request);
+          }
+          return res;
+        }
+
+        std::vector<std::vector<Eigen::Vector3d> > getIntersectionPoints
+            (const BVHModelOBConst_Ptr_t& romModel, const std::vector<fcl::Transform3f>& romPoses,
+             const fcl::CollisionObjectPtr_t& affordance, const IntersectionRequest& request)
+        {
+          std::vector<std::vector<Eigen::Vector3d> > res (romPoses.size ());
+          BVHModelOBConst_Ptr_t affModel (GetModel (affordance));
+          // model frame data of both meshes are prepared once for all poses
+          MeshCache cache;
+          IntersectionWorkspace workspace;
+          fcl::Matrix3f affR;
+          fcl::Vec3f affT;
+          const bool hierarchies (romModel->getNumBVs () > 0 && affModel->getNumBVs () > 0);
+          for (std::size_t k = 0; k < romPoses.size (); ++k) {
+              relativeTransform (romPoses[k], affordance->getTransform (), affR, affT);
+              if (hierarchies &&
+                      !fcl::overlap (affR, affT, romModel->getBV (0).bv, affModel->getBV (0).bv)) {
+                  continue;
+              }
+              res[k] = intersectInModelFrame (romModel, romPoses[k], affModel,
+                      affordance->getTransform (), cache, workspace, NULL, request);
+          }
+          return res;
         }
 
     } // namespace intersect
@@ -0,0 +1,108 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#include "merge-points.hh"
+#include <cmath>
+
+namespace hpp {
+    namespace intersect {
+        namespace {
+          // hash of an integer grid cell, see "Optimized Spatial Hashing for Collision
+          // Detection of Deformable Objects", M. Teschner et al., VMV 2003
+          inline std::size_t cellHash (const long long i, const long long j, const long long k)
+          {
+            // unsigned arithmetic: wrapping around is well defined
+            return (std::size_t) (((unsigned long long) i * 73856093ULL) ^
+                    ((unsigned long long) j * 19349663ULL) ^ ((unsigned long long) k * 83492791ULL));
+          }
+
+          // merge the points, and if ids is not null, store for each input point the
+          // index of the point it is merged to
+          void merge (std::vector<Eigen::Vector3d>& points, const double tolerance,
+                  std::vector<int>& table, int* ids)
+          {
+            if (tolerance <= 0. || points.size () < 2) {
+                for (std::size_t n = 0; ids && n < points.size (); ++n) {
+                    ids[n] = (int) n;
+                }
+                return;
+            }
+            // open addressing table of the indices of kept points, at most half full
+            std::size_t size = 1;
+            while (size < 2 * points.size ()) {
+                size <<= 1;
+            }
+            table.assign (size, -1);
+            const std::size_t mask = size - 1;
+            const double scale = 1. / tolerance;
+            const double squaredTolerance = tolerance * tolerance;
+
+            std::size_t nKept = 0;
+            for (std::size_t n = 0; n < points.size (); ++n) {
+                const Eigen::Vector3d point (points[n]);
+                const long long i ((long long) std::floor (point[0] * scale));
+                const long long j ((long long) std::floor (point[1] * scale));
+                const long long k ((long long) std::floor (point[2] * scale));
+                // any kept point closer than tolerance lies in one of the neighbouring cells
+                int merged = -1;
+                for (int di = -1; di <= 1 && merged < 0; ++di) {
+                    for (int dj = -1; dj <= 1 && merged < 0; ++dj) {
+                        for (int dk = -1; dk <= 1 && merged < 0; ++dk) {
+                            for (std::size_t h = cellHash (i+di, j+dj, k+dk) & mask;
+                                    table[h] >= 0; h = (h + 1) & mask) {
+                                if ((points[table[h]] - point).squaredNorm () < squaredTolerance) {
+                                    merged = table[h];
+                                    break;
+                                }
+                            }
+                        }
+                    }
+                }
+                if (ids) {
+                    ids[n] = merged < 0 ? (int) nKept : merged;
+                }
+                if (merged >= 0) {
+                    continue;
+                }
+                std::size_t h = cellHash (i, j, k) & mask;
+                while (table[h] >= 0) {
+                    h = (h + 1) & mask;
+                }
+                table[h] = (int) nKept;
+                points[nKept++] = point;
+            }
+            points.resize (nKept);
+          }
+        } // namespace
+
+        void mergeClosePoints (std::vector<Eigen::Vector3d>& points, const double tolerance,
+                std::vector<int>& table)
+        {
+          merge (points, tolerance, table, 0);
+        }
+
+        void mergeClosePoints (std::vector<Eigen::Vector3d>& points, const double tolerance,
+                std::vector<int>& table, std::vector<int>& ids)
+        {
+          ids.resize (points.size ());
+          merge (points, tolerance, table, ids.empty () ? 0 : &ids[0]);
+        }
+
+    } // namespace intersect
+} // namespace hpp
@@ -0,0 +1,48 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#ifndef HPP_INTERSECT_MERGE_POINTS_HH
+#define HPP_INTERSECT_MERGE_POINTS_HH
+
+#include <vector>
+#include <Eigen/Core>
+
+namespace hpp {
+    namespace intersect {
+
+        /// Remove the points closer than tolerance to a point kept before them, keeping
+        /// the order of the remaining points. Close points are found with a spatial hash
+        /// of the cells of a grid of size tolerance: only the points hashed to the 27 cells
+        /// around a point are compared to it. Nothing is removed if tolerance <= 0.
+        /// \param points points to merge, replaced by the kept points.
+        /// \param tolerance distance under which two points are merged.
+        /// \param table storage of the hash table, reused across calls.
+        void mergeClosePoints (std::vector<Eigen::Vector3d>& points, const double tolerance,
+                std::vector<int>& table);
+
+        /// Same as above, and give for each input point the index of the kept point it
+        /// is merged with, which is the point itself if it is kept.
+        /// \param ids filled with the index in the kept points of each input point.
+        void mergeClosePoints (std::vector<Eigen::Vector3d>& points, const double tolerance,
+                std::vector<int>& table, std::vector<int>& ids);
+
+    } // namespace intersect
+} // namespace hpp
+
+#endif // HPP_INTERSECT_MERGE_POINTS_HH
@@ -0,0 +1,158 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#include <hpp/intersect/polytope.hh>
+#include "inside-block.hh"
+#include <algorithm>
+
+namespace hpp {
+    namespace intersect {
+
+        Polytope::Polytope (): center_ (Eigen::Vector3d::Zero ()), innerRadius_ (-1.),
+            outerRadius_ (-1.)
+        {}
+
+        Polytope::Polytope (const Inequality& ineq, const std::vector<Eigen::Vector3d>& vertices):
+            center_ (Eigen::Vector3d::Zero ()), innerRadius_ (-1.), outerRadius_ (-1.)
+        {
+          // rows with a null normal (degenerate triangles) constrain nothing
+          std::size_t nPlanes = 0;
+          for (int k = 0; k < ineq.A_.rows (); ++k) {
+              nPlanes += ineq.A_.row (k).squaredNorm () > 0.;
+          }
+          normalX_.resize (nPlanes);
+          normalY_.resize (nPlanes);
+          normalZ_.resize (nPlanes);
+          offsets_.resize (nPlanes);
+          nPlanes = 0;
+          for (int k = 0; k < ineq.A_.rows (); ++k) {
+              const double norm (ineq.A_.row (k).norm ());
+              if (norm > 0.) {
+                  normalX_[nPlanes] = ineq.A_ (k, 0) / norm;
+                  normalY_[nPlanes] = ineq.A_ (k, 1) / norm;
+                  normalZ_[nPlanes] = ineq.A_ (k, 2) / norm;
+                  offsets_[nPlanes] = ineq.b_ (k) / norm;
+                  ++nPlanes;
+              }
+          }
+          if (vertices.empty ()) {
+              return;
+          }
+          // the mean of the vertices of a convex object is inside it: the distance to
+          // the closest plane gives an inscribed sphere, the farthest vertex a bounding one
+          for (std::size_t i = 0; i < vertices.size (); ++i) {
+              center_ += vertices[i];
+          }
+          center_ /= (double) vertices.size ();
+          outerRadius_ = 0.;
+          for (std::size_t i = 0; i < vertices.size (); ++i) {
+              outerRadius_ = std::max (outerRadius_, (vertices[i] - center_).norm ());
+          }
+          if (nPlanes > 0) {
+              innerRadius_ = (offsets_.array () - normalX_.array () * center_[0] -
+                      normalY_.array () * center_[1] - normalZ_.array () * center_[2]).minCoeff ();
+          }
+        }
+
+        bool Polytope::contains (const Eigen::Vector3d& point) const
+        {
+          if (size () == 0) {
+              return false;
+          }
+          const double d2 ((point - center_).squaredNorm ());
+          if (d2 <= innerRadius_ * innerRadius_ && innerRadius_ >= 0.) {
+              return true;
+          }
+          // no bounding sphere without vertices
+          if (d2 > outerRadius_ * outerRadius_ && outerRadius_ >= 0.) {
+              return false;
+          }
+          return insidePlanes (point);
+        }
+
+        bool Polytope::insidePlanes (const Eigen::Vector3d& point) const
+        {
+          // number of planes tested before checking for a plane the point is outside of
+          const int groupSize = 32;
+          const int nPlanes ((int) offsets_.size ());
+          for (int first = 0; first < nPlanes; first += groupSize) {
+              const int n (std::min (groupSize, nPlanes - first));
+              if (((normalX_.segment (first, n).array () * point[0] +
+                              normalY_.segment (first, n).array () * point[1] +
+                              normalZ_.segment (first, n).array () * point[2] -
+                              offsets_.segment (first, n).array ()) > 0.).any ()) {
+                  return false;
+              }
+          }
+          return true;
+        }
+
+        void Polytope::contains (const Eigen::Matrix3Xd& points, std::vector<std::size_t>& inside) const
+        {
+          inside.clear ();
+          PointBlock_t block;
+          int ids[INSIDE_BLOCK_SIZE];
+          const std::size_t nCols ((std::size_t) points.cols ());
+          for (std::size_t first = 0; first < nCols; first += INSIDE_BLOCK_SIZE) {
+              const int nPoints ((int) std::min<std::size_t> (INSIDE_BLOCK_SIZE, nCols - first));
+              block = points.middleCols (first, nPoints);
+              const int nInside (insideBlock (*this, block, nPoints, ids));
+              for (int i = 0; i < nInside; ++i) {
+                  inside.push_back (first + ids[i]);
+              }
+          }
+        }
+
+        bool Polytope::contains (const fcl::Transform3f& pose, const Eigen::Vector3d& point) const
+        {
+          return contains (Eigen::Vector3d (pose.getRotation ().transpose () *
+                      (point - pose.getTranslation ())));
+        }
+
+        void Polytope::contains (const fcl::Transform3f& pose, const Eigen::Matrix3Xd& points,
+                std::vector<std::size_t>& inside) const
+        {
+          inside.clear ();
+          const fcl::Matrix3f rotT (pose.getRotation ().transpose ());
+          const fcl::Vec3f translation (pose.getTranslation ());
+          PointBlock_t block;
+          int ids[INSIDE_BLOCK_SIZE];
+          const std::size_t nCols ((std::size_t) points.cols ());
+          for (std::size_t first = 0; first < nCols; first += INSIDE_BLOCK_SIZE) {
+              const int nPoints ((int) std::min<std::size_t> (INSIDE_BLOCK_SIZE, nCols - first));
+              block.noalias () = rotT * (points.middleCols (first, nPoints).colwise () - translation);
+              const int nInside (insideBlock (*this, block, nPoints, ids));
+              for (int i = 0; i < nInside; ++i) {
+                  inside.push_back (first + ids[i]);
+              }
+          }
+        }
+
+        Polytope fcl2polytope (const fcl::CollisionObjectPtr_t& rom)
+        {
+          WeldedMesh mesh; // unique vertices in model frame
+          weldMesh (*GetModel (rom), 1e-9, mesh);
+          const Eigen::MatrixXd empty;
+          Inequality ineq (empty, Eigen::VectorXd (), empty, empty);
+          convexHullInequalities (mesh, ineq);
+          return Polytope (ineq, mesh.vertices_);
+        }
+
+    } // namespace intersect
+} // namespace hpp
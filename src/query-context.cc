@@ -0,0 +1,88 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#include <hpp/intersect/query-context.hh>
+#include <algorithm>
+
+namespace hpp {
+    namespace intersect {
+
+        QueryContext::QueryContext (const double margin): margin_ (margin), romRadius_ (0.),
+            valid_ (false), traversals_ (0), reuses_ (0)
+        {
+          rotation_.setIdentity ();
+          translation_.setZero ();
+        }
+
+        void QueryContext::reset ()
+        {
+          romModel_.reset ();
+          affModel_.reset ();
+          valid_ = false;
+          pairs_.clear ();
+          vertices_.clear ();
+        }
+
+        void QueryContext::setModels (const BVHModelOBConst_Ptr_t& romModel,
+                const BVHModelOBConst_Ptr_t& affModel)
+        {
+          if (romModel == romModel_ && affModel == affModel_) {
+              return;
+          }
+          reset ();
+          romModel_ = romModel;
+          affModel_ = affModel;
+          // read from the vertices: the AABB fields of a model are only set when it
+          // is wrapped in a fcl::CollisionObject
+          double radius2 = 0.;
+          for (int i = 0; i < romModel->num_vertices; ++i) {
+              radius2 = std::max (radius2, Eigen::Vector3d (romModel->vertices[i]).squaredNorm ());
+          }
+          romRadius_ = std::sqrt (radius2);
+        }
+
+        bool QueryContext::reuse (const fcl::Matrix3f& R, const fcl::Vec3f& T)
+        {
+          if (!valid_) {
+              return false;
+          }
+          // a point x of the rom moves by (R - rotation_) x + T - translation_; the
+          // Frobenius norm bounds the norm of the rotation difference
+          const double displacement ((R - rotation_).norm () * romRadius_ +
+                  (T - translation_).norm ());
+          if (displacement > margin_) {
+              return false;
+          }
+          ++reuses_;
+          return true;
+        }
+
+        void QueryContext::store (const fcl::Matrix3f& R, const fcl::Vec3f& T,
+                const std::vector<std::pair<int, int> >& pairs, const std::vector<int>& vertices)
+        {
+          rotation_ = R;
+          translation_ = T;
+          pairs_ = pairs;
+          vertices_ = vertices;
+          valid_ = true;
+          ++traversals_;
+        }
+
+    } // namespace intersect
+} // namespace hpp
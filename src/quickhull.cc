@@ -0,0 +1,273 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#include "quickhull.hh"
+#include <Eigen/Geometry>
+#include <map>
+#include <algorithm>
+#include <cmath>
+
+namespace hpp {
+    namespace intersect {
+        namespace {
+          // triangular facet of the hull under construction, vertices in counter
+          // clockwise order seen from outside
+          struct Face
+          {
+            int v_[3];
+            Eigen::Vector3d normal_;
+            double offset_;
+            // points above the face not yet added to the hull
+            std::vector<int> outside_;
+            bool alive_;
+          };
+
+          typedef std::map<std::pair<int, int>, std::size_t> EdgeMap_t;
+
+          inline double distance (const Face& face, const Eigen::Vector3d& point)
+          {
+            return face.normal_.dot (point) - face.offset_;
+          }
+
+          // add face (a, b, c) and register its directed edges. Returns false if one of
+          // its edges is already used, which means the hull is no longer a manifold.
+          bool addFace (const std::vector<Eigen::Vector3d>& points, const int a, const int b,
+                  const int c, std::vector<Face>& faces, EdgeMap_t& edges)
+          {
+            Face face;
+            face.v_[0] = a; face.v_[1] = b; face.v_[2] = c;
+            face.normal_ = (points[b] - points[a]).cross (points[c] - points[a]).normalized ();
+            face.offset_ = face.normal_.dot (points[a]);
+            face.alive_ = true;
+            for (int i = 0; i < 3; ++i) {
+                if (!edges.insert (std::make_pair (std::make_pair (face.v_[i], face.v_[(i+1)%3]),
+                                faces.size ())).second) {
+                    return false;
+                }
+            }
+            faces.push_back (face);
+            return true;
+          }
+
+          // give each point to the first face it is above, points below all faces are dropped
+          void assign (const std::vector<Eigen::Vector3d>& points, const std::vector<int>& indices,
+                  const double tolerance, const std::size_t firstFace, std::vector<Face>& faces)
+          {
+            for (std::size_t i = 0; i < indices.size (); ++i) {
+                for (std::size_t f = firstFace; f < faces.size (); ++f) {
+                    if (distance (faces[f], points[indices[i]]) > tolerance) {
+                        faces[f].outside_.push_back (indices[i]);
+                        break;
+                    }
+                }
+            }
+          }
+
+          // index of the point farthest from the line (a, b) or, if c >= 0, from the plane (a, b, c)
+          int farthest (const std::vector<Eigen::Vector3d>& points, const int a, const int b,
+                  const int c, double& maxDist)
+          {
+            int res = -1;
+            maxDist = 0.;
+            const Eigen::Vector3d u ((points[b] - points[a]).normalized ());
+            Eigen::Vector3d normal;
+            if (c >= 0) {
+                normal = u.cross (points[c] - points[a]).normalized ();
+            }
+            for (std::size_t i = 0; i < points.size (); ++i) {
+                const Eigen::Vector3d d (points[i] - points[a]);
+                const double dist (c >= 0 ? std::fabs (normal.dot (d)) : (d - u.dot (d) * u).norm ());
+                if (dist > maxDist) {
+                    maxDist = dist;
+                    res = (int) i;
+                }
+            }
+            return res;
+          }
+        } // namespace
+
+        HullStatus quickHull (const std::vector<Eigen::Vector3d>& points, const double tolerance,
+                std::vector<HullPlane>& planes)
+        {
+          planes.clear ();
+          if (points.size () < 4) {
+              return HULL_FLAT;
+          }
+          // initial tetrahedron: extreme points along the axis of largest extent, then the
+          // points farthest from their line and from the plane of the three.
+          Eigen::Vector3d minPoint (points[0]), maxPoint (points[0]);
+          for (std::size_t i = 1; i < points.size (); ++i) {
+              minPoint = minPoint.cwiseMin (points[i]);
+              maxPoint = maxPoint.cwiseMax (points[i]);
+          }
+          int axis;
+          (maxPoint - minPoint).maxCoeff (&axis);
+          int i0 = 0, i1 = 0;
+          for (std::size_t i = 1; i < points.size (); ++i) {
+              if (points[i][axis] < points[i0][axis]) i0 = (int) i;
+              if (points[i][axis] > points[i1][axis]) i1 = (int) i;
+          }
+          double dist;
+          if ((points[i1] - points[i0]).norm () <= tolerance) {
+              return HULL_FLAT;
+          }
+          const int i2 = farthest (points, i0, i1, -1, dist);
+          if (dist <= tolerance) {
+              return HULL_FLAT;
+          }
+          const int i3 = farthest (points, i0, i1, i2, dist);
+          if (dist <= tolerance) {
+              return HULL_FLAT;
+          }
+
+          std::vector<Face> faces;
+          EdgeMap_t edges;
+          const int simplex[4] = {i0, i1, i2, i3};
+          const Eigen::Vector3d center ((points[i0] + points[i1] + points[i2] + points[i3]) / 4.);
+          for (int k = 0; k < 4; ++k) {
+              int a = simplex[k], b = simplex[(k+1)%4], c = simplex[(k+2)%4];
+              if (((points[b] - points[a]).cross (points[c] - points[a])).dot (center - points[a]) > 0.) {
+                  std::swap (b, c);
+              }
+              addFace (points, a, b, c, faces, edges);
+          }
+          std::vector<int> indices;
+          for (std::size_t i = 0; i < points.size (); ++i) {
+              if ((int) i != i0 && (int) i != i1 && (int) i != i2 && (int) i != i3) {
+                  indices.push_back ((int) i);
+              }
+          }
+          assign (points, indices, tolerance, 0, faces);
+
+          std::vector<std::size_t> visible, stack;
+          std::vector<std::pair<int, int> > horizon;
+          // iteration + 1 at which each face was visited, so that the marks of previous
+          // iterations need not be reset
+          std::vector<std::size_t> visited;
+          // points are only given to the faces created by an iteration, which are appended:
+          // faces found dead or without outside point stay so, the search resumes after them
+          std::size_t current = 0;
+          // each iteration adds one point to the hull: at most points.size () iterations
+          for (std::size_t iteration = 0; iteration < points.size (); ++iteration) {
+              while (current < faces.size () &&
+                      (!faces[current].alive_ || faces[current].outside_.empty ())) {
+                  ++current;
+              }
+              if (current == faces.size ()) {
+                  break;
+              }
+              // the farthest point above the face is a vertex of the hull
+              const std::vector<int>& outside = faces[current].outside_;
+              int eye = outside[0];
+              for (std::size_t i = 1; i < outside.size (); ++i) {
+                  if (distance (faces[current], points[outside[i]]) >
+                          distance (faces[current], points[eye])) {
+                      eye = outside[i];
+                  }
+              }
+              // faces seen from the eye, and the horizon edges bounding them
+              visible.clear ();
+              horizon.clear ();
+              visited.resize (faces.size (), 0);
+              const std::size_t mark = iteration + 1;
+              stack.assign (1, current);
+              visited[current] = mark;
+              while (!stack.empty ()) {
+                  const std::size_t f = stack.back ();
+                  stack.pop_back ();
+                  visible.push_back (f);
+                  for (int i = 0; i < 3; ++i) {
+                      const int a = faces[f].v_[i], b = faces[f].v_[(i+1)%3];
+                      EdgeMap_t::const_iterator twin = edges.find (std::make_pair (b, a));
+                      if (twin == edges.end ()) {
+                          return HULL_NOT_MANIFOLD;
+                      }
+                      const std::size_t g = twin->second;
+                      if (visited[g] == mark) {
+                          continue;
+                      }
+                      if (distance (faces[g], points[eye]) > tolerance) {
+                          visited[g] = mark;
+                          stack.push_back (g);
+                      } else {
+                          horizon.push_back (std::make_pair (a, b));
+                      }
+                  }
+              }
+              // remove the visible faces and cone the horizon to the eye
+              indices.clear ();
+              for (std::size_t k = 0; k < visible.size (); ++k) {
+                  Face& face = faces[visible[k]];
+                  face.alive_ = false;
+                  for (int i = 0; i < 3; ++i) {
+                      edges.erase (std::make_pair (face.v_[i], face.v_[(i+1)%3]));
+                  }
+                  for (std::size_t i = 0; i < face.outside_.size (); ++i) {
+                      if (face.outside_[i] != eye) {
+                          indices.push_back (face.outside_[i]);
+                      }
+                  }
+                  std::vector<int> ().swap (face.outside_);
+              }
+              const std::size_t firstFace = faces.size ();
+              for (std::size_t k = 0; k < horizon.size (); ++k) {
+                  if (!addFace (points, horizon[k].first, horizon[k].second, eye, faces, edges)) {
+                      return HULL_NOT_MANIFOLD;
+                  }
+              }
+              assign (points, indices, tolerance, firstFace, faces);
+          }
+
+          // one plane per facet: triangles whose vertices all lie on the plane of a
+          // facet with the same orientation belong to it
+          for (std::size_t f = 0; f < faces.size (); ++f) {
+              const Face& face = faces[f];
+              if (!face.alive_) {
+                  continue;
+              }
+              bool merged = false;
+              for (std::size_t k = 0; k < planes.size () && !merged; ++k) {
+                  HullPlane& plane = planes[k];
+                  if (plane.normal_.dot (face.normal_) <= 0.) {
+                      continue;
+                  }
+                  merged = true;
+                  for (int i = 0; i < 3 && merged; ++i) {
+                      merged = std::fabs (plane.normal_.dot (points[face.v_[i]]) - plane.offset_)
+                          <= tolerance;
+                  }
+                  if (merged) {
+                      for (int i = 0; i < 3; ++i) {
+                          plane.offset_ = std::max (plane.offset_, plane.normal_.dot (points[face.v_[i]]));
+                      }
+                  }
+              }
+              if (!merged) {
+                  HullPlane plane;
+                  plane.normal_ = face.normal_;
+                  plane.offset_ = face.offset_;
+                  plane.point_ = points[face.v_[0]];
+                  planes.push_back (plane);
+              }
+          }
+          return HULL_OK;
+        }
+
+    } // namespace intersect
+} // namespace hpp
@@ -0,0 +1,67 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#ifndef HPP_INTERSECT_QUICKHULL_HH
+#define HPP_INTERSECT_QUICKHULL_HH
+
+#include <vector>
+#include <Eigen/Core>
+
+namespace hpp {
+    namespace intersect {
+
+        /// Facet of a 3D convex hull: the points x of the hull satisfy
+        /// normal_.dot (x) <= offset_, with equality on the facet.
+        struct HullPlane
+        {
+          /// unit outward normal
+          Eigen::Vector3d normal_;
+          double offset_;
+          /// one of the input points lying on the facet
+          Eigen::Vector3d point_;
+        };
+
+        /// Result of intersect::quickHull.
+        enum HullStatus
+        {
+          /// the hull was built
+          HULL_OK,
+          /// the points do not span a volume: fewer than 4 points, or all of them
+          /// closer than the tolerance to a plane
+          HULL_FLAT,
+          /// rounding errors made the hull under construction lose an edge or reuse one,
+          /// so that it is no longer a closed manifold
+          HULL_NOT_MANIFOLD
+        };
+
+        /// Compute the facets of the convex hull of a set of points with the quickhull
+        /// algorithm ("The Quickhull Algorithm for Convex Hulls", C. B. Barber et al.,
+        /// ACM TOMS 1996). Points closer than tolerance to a facet are considered on it,
+        /// and adjacent coplanar triangles are merged so that each facet gives one plane.
+        /// Unless HULL_OK is returned, planes is left empty.
+        /// \param points input points.
+        /// \param tolerance distance under which a point is considered on a plane.
+        /// \param planes the facets of the hull, replaced.
+        HullStatus quickHull (const std::vector<Eigen::Vector3d>& points, const double tolerance,
+                std::vector<HullPlane>& planes);
+
+    } // namespace intersect
+} // namespace hpp
+
+#endif // HPP_INTERSECT_QUICKHULL_HH
@@ -0,0 +1,115 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#include "resample-hull.hh"
+#include <Eigen/Geometry>
+#include <cmath>
+#include <limits>
+
+namespace hpp {
+    namespace intersect {
+        namespace {
+          // twice the area of the triangle of a vertex and its two neighbours
+          inline double cornerArea (const Eigen::Vector3d& previous, const Eigen::Vector3d& vertex,
+                  const Eigen::Vector3d& next)
+          {
+            return (vertex - previous).cross (next - vertex).norm ();
+          }
+
+          // keep the maxPoints vertices of the hull that contribute most to its area
+          void simplify (const std::vector<Eigen::Vector3d>& hull, const std::size_t maxPoints,
+                  std::vector<Eigen::Vector3d>& region)
+          {
+            region.assign (hull.begin (), hull.end () - 1);
+            while (region.size () > maxPoints && region.size () > 1) {
+                const std::size_t n = region.size ();
+                std::size_t removed = 0;
+                double smallest = std::numeric_limits<double>::max ();
+                for (std::size_t k = 0; k < n; ++k) {
+                    const double area (cornerArea (region[(k + n - 1) % n], region[k],
+                                region[(k + 1) % n]));
+                    if (area < smallest) {
+                        smallest = area;
+                        removed = k;
+                    }
+                }
+                region.erase (region.begin () + removed);
+            }
+          }
+        } // namespace
+
+        void resampleHull (const std::vector<Eigen::Vector3d>& hull, const double maxSpacing,
+                const std::size_t maxPoints, std::vector<Eigen::Vector3d>& region)
+        {
+          region.clear ();
+          if (hull.size () < 2) {
+              return;
+          }
+          const std::size_t nEdges = hull.size () - 1;
+          double spacing = maxSpacing;
+          if (spacing <= 0.) {
+              spacing = 0.1; //10 cm minimum interval
+              for (std::size_t k = 0; k < nEdges; ++k) {
+                  const double length ((hull[k+1] - hull[k]).norm ());
+                  if (spacing > length && length > 0.01) {
+                      spacing = length;
+                  }
+              }
+          }
+          std::size_t nSamples = 0;
+          double perimeter = 0.;
+          for (std::size_t k = 0; k < nEdges; ++k) {
+              const double length ((hull[k+1] - hull[k]).norm ());
+              nSamples += (std::size_t) std::ceil (length / spacing);
+              perimeter += length;
+          }
+          if (maxPoints > 0 && nSamples > maxPoints) {
+              if (maxPoints <= nEdges) {
+                  simplify (hull, maxPoints, region);
+                  return;
+              }
+              // one interval per edge, and the remaining samples distributed by rounding
+              // the cumulated length so that their total is exact
+              const double extra ((double) (maxPoints - nEdges));
+              double cumulated = 0.;
+              std::size_t previous = 0;
+              for (std::size_t k = 0; k < nEdges; ++k) {
+                  const Eigen::Vector3d edge (hull[k+1] - hull[k]);
+                  cumulated += edge.norm ();
+                  const std::size_t next ((std::size_t) std::floor
+                          (extra * cumulated / perimeter + 0.5));
+                  const std::size_t intervals (1 + (next > previous ? next - previous : 0));
+                  previous = next > previous ? next : previous;
+                  for (std::size_t i = 0; i < intervals; ++i) {
+                      region.push_back (hull[k] + ((double) (i+1) / (double) intervals) * edge);
+                  }
+              }
+              return;
+          }
+          for (std::size_t k = 0; k < nEdges; ++k) {
+              const Eigen::Vector3d edge (hull[k+1] - hull[k]);
+              const std::size_t intervals ((std::size_t) std::ceil (edge.norm () / spacing));
+              for (std::size_t i = 0; i < intervals; ++i) {
+                  region.push_back (hull[k] + ((double) (i+1) / (double) intervals) * edge);
+              }
+          }
+        }
+
+    } // namespace intersect
+} // namespace hpp
@@ -0,0 +1,49 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#ifndef HPP_INTERSECT_RESAMPLE_HULL_HH
+#define HPP_INTERSECT_RESAMPLE_HULL_HH
+
+#include <vector>
+#include <Eigen/Core>
+
+namespace hpp {
+    namespace intersect {
+
+        /// Sample the boundary of a convex hull for the ellipse fit of the contact region.
+        /// Each edge is divided in intervals no longer than maxSpacing and the end of each
+        /// interval is added to region; the hull vertices are always among the samples.
+        /// If maxSpacing <= 0, the spacing is the length of the shortest edge longer
+        /// than 1 cm, and at most 10 cm.
+        /// If maxPoints > 0, region has at most maxPoints points: when the spacing gives
+        /// more samples, the samples left after the hull vertices are spread over the
+        /// edges in proportion to their length and, when there are more vertices than
+        /// maxPoints, the vertices spanning the smallest triangle with their neighbours
+        /// are removed first (Visvalingam-Whyatt simplification).
+        /// \param hull closed convex polygon, first point repeated at the end.
+        /// \param maxSpacing maximum distance between two consecutive samples.
+        /// \param maxPoints maximum number of samples, 0 for no limit.
+        /// \param region the samples, replaced.
+        void resampleHull (const std::vector<Eigen::Vector3d>& hull, const double maxSpacing,
+                const std::size_t maxPoints, std::vector<Eigen::Vector3d>& region);
+
+    } // namespace intersect
+} // namespace hpp
+
+#endif // HPP_INTERSECT_RESAMPLE_HULL_HH
@@ -0,0 +1,220 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#include <hpp/intersect/result-cache.hh>
+#include <Eigen/Geometry>
+#include <boost/functional/hash.hpp>
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace hpp {
+    namespace intersect {
+
+        struct ResultCache::Key
+        {
+          bool operator== (const Key& other) const
+          {
+            return rom_ == other.rom_ && aff_ == other.aff_ &&
+                std::equal (pose_, pose_ + 7, other.pose_);
+          }
+          const BVHModelOB* rom_;
+          const BVHModelOB* aff_;
+          // cell of the translation, then of the rotation quaternion (w, x, y, z),
+          // of the affordance model in the rom model frame
+          long long pose_[7];
+          std::size_t hash_;
+        };
+
+        struct ResultCache::Shard
+        {
+          struct KeyHash
+          {
+            std::size_t operator () (const Key& key) const
+            {
+              return key.hash_;
+            }
+          };
+          struct Entry
+          {
+            Key key_;
+            // models are kept to guarantee the key stays unique
+            BVHModelOBConst_Ptr_t romModel_;
+            BVHModelOBConst_Ptr_t affModel_;
+            // region in the rom model frame
+            std::vector<Eigen::Vector3d> region_;
+          };
+          typedef std::list<Entry> Entries_t;
+
+          Shard (): hits_ (0), misses_ (0) {}
+
+          std::mutex mutex_;
+          // most recently used first
+          Entries_t entries_;
+          std::unordered_map<Key, Entries_t::iterator, KeyHash> index_;
+          std::size_t hits_;
+          std::size_t misses_;
+        };
+
+        ResultCache::ResultCache (const std::size_t capacity, const double resolution,
+                const double angularResolution, const unsigned int nShards):
+            shardCapacity_ (std::max<std::size_t> (1, (capacity + nShards - 1) / std::max (1u, nShards))),
+            resolution_ (resolution), angularResolution_ (angularResolution)
+        {
+          assert (resolution > 0. && angularResolution > 0.);
+          for (unsigned int k = 0; k < std::max (1u, nShards); ++k) {
+              shards_.push_back (boost::shared_ptr<Shard> (new Shard));
+          }
+        }
+
+        ResultCache::Key ResultCache::key (const BVHModelOBConst_Ptr_t& romModel,
+                const fcl::Transform3f& romPose, const BVHModelOBConst_Ptr_t& affModel,
+                const fcl::Transform3f& affPose) const
+        {
+          Key key;
+          key.rom_ = romModel.get ();
+          key.aff_ = affModel.get ();
+          const fcl::Matrix3f romRotT (romPose.getRotation ().transpose ());
+          const Eigen::Vector3d translation (romRotT * (affPose.getTranslation () -
+                      romPose.getTranslation ()));
+          Eigen::Quaterniond rotation (Eigen::Matrix3d (romRotT * affPose.getRotation ()));
+          // q and -q are the same rotation
+          if (rotation.w () < 0.) {
+              rotation.coeffs () *= -1.;
+          }
+          // a rotation by a small angle changes the quaternion by half that angle
+          const double quaternionStep (.5 * angularResolution_);
+          for (int i = 0; i < 3; ++i) {
+              key.pose_[i] = (long long) std::floor (translation[i] / resolution_ + .5);
+          }
+          key.pose_[3] = (long long) std::floor (rotation.w () / quaternionStep + .5);
+          key.pose_[4] = (long long) std::floor (rotation.x () / quaternionStep + .5);
+          key.pose_[5] = (long long) std::floor (rotation.y () / quaternionStep + .5);
+          key.pose_[6] = (long long) std::floor (rotation.z () / quaternionStep + .5);
+          key.hash_ = 0;
+          boost::hash_combine (key.hash_, key.rom_);
+          boost::hash_combine (key.hash_, key.aff_);
+          for (int i = 0; i < 7; ++i) {
+              boost::hash_combine (key.hash_, key.pose_[i]);
+          }
+          return key;
+        }
+
+        bool ResultCache::find (const BVHModelOBConst_Ptr_t& romModel,
+                const fcl::Transform3f& romPose, const BVHModelOBConst_Ptr_t& affModel,
+                const fcl::Transform3f& affPose, std::vector<Eigen::Vector3d>& region)
+        {
+          const Key k (key (romModel, romPose, affModel, affPose));
+          Shard& shard = *shards_[k.hash_ % shards_.size ()];
+          std::lock_guard<std::mutex> lock (shard.mutex_);
+          const std::unordered_map<Key, Shard::Entries_t::iterator, Shard::KeyHash>::iterator
+              it = shard.index_.find (k);
+          if (it == shard.index_.end ()) {
+              ++shard.misses_;
+              return false;
+          }
+          ++shard.hits_;
+          shard.entries_.splice (shard.entries_.begin (), shard.entries_, it->second);
+          const std::vector<Eigen::Vector3d>& stored = it->second->region_;
+          region.resize (stored.size ());
+          for (std::size_t i = 0; i < stored.size (); ++i) {
+              region[i] = romPose.getRotation () * stored[i] + romPose.getTranslation ();
+          }
+          return true;
+        }
+
+        void ResultCache::insert (const BVHModelOBConst_Ptr_t& romModel,
+                const fcl::Transform3f& romPose, const BVHModelOBConst_Ptr_t& affModel,
+                const fcl::Transform3f& affPose, const std::vector<Eigen::Vector3d>& region)
+        {
+          const Key k (key (romModel, romPose, affModel, affPose));
+          // the region is moved to the rom frame outside of the lock
+          Shard::Entry entry;
+          entry.key_ = k;
+          entry.romModel_ = romModel;
+          entry.affModel_ = affModel;
+          entry.region_.resize (region.size ());
+          const fcl::Matrix3f romRotT (romPose.getRotation ().transpose ());
+          for (std::size_t i = 0; i < region.size (); ++i) {
+              entry.region_[i] = romRotT * (region[i] - romPose.getTranslation ());
+          }
+          Shard& shard = *shards_[k.hash_ % shards_.size ()];
+          std::lock_guard<std::mutex> lock (shard.mutex_);
+          const std::unordered_map<Key, Shard::Entries_t::iterator, Shard::KeyHash>::iterator
+              it = shard.index_.find (k);
+          if (it != shard.index_.end ()) {
+              // another thread computed the same region in the meantime
+              it->second->region_.swap (entry.region_);
+              shard.entries_.splice (shard.entries_.begin (), shard.entries_, it->second);
+              return;
+          }
+          if (shard.entries_.size () >= shardCapacity_) {
+              shard.index_.erase (shard.entries_.back ().key_);
+              shard.entries_.pop_back ();
+          }
+          shard.entries_.push_front (entry);
+          shard.index_[k] = shard.entries_.begin ();
+        }
+
+        std::size_t ResultCache::hits () const
+        {
+          std::size_t res = 0;
+          for (std::size_t k = 0; k < shards_.size (); ++k) {
+              std::lock_guard<std::mutex> lock (shards_[k]->mutex_);
+              res += shards_[k]->hits_;
+          }
+          return res;
+        }
+
+        std::size_t ResultCache::misses () const
+        {
+          std::size_t res = 0;
+          for (std::size_t k = 0; k < shards_.size (); ++k) {
+              std::lock_guard<std::mutex> lock (shards_[k]->mutex_);
+              res += shards_[k]->misses_;
+          }
+          return res;
+        }
+
+        std::size_t ResultCache::size () const
+        {
+          std::size_t res = 0;
+          for (std::size_t k = 0; k < shards_.size (); ++k) {
+              std::lock_guard<std::mutex> lock (shards_[k]->mutex_);
+              res += shards_[k]->entries_.size ();
+          }
+          return res;
+        }
+
+        void ResultCache::clear ()
+        {
+          for (std::size_t k = 0; k < shards_.size (); ++k) {
+              Shard& shard = *shards_[k];
+              std::lock_guard<std::mutex> lock (shard.mutex_);
+              shard.index_.clear ();
+              shard.entries_.clear ();
+              shard.hits_ = 0;
+              shard.misses_ = 0;
+          }
+        }
+
+    } // namespace intersect
+} // namespace hpp
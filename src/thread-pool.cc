@@ -0,0 +1,124 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#include "thread-pool.hh"
+
+namespace hpp {
+    namespace intersect {
+
+        // one call of a task, completion is counted on the batch it belongs to
+        struct ThreadPool::Job
+        {
+          const std::function<void (unsigned int)>* task;
+          unsigned int index;
+          unsigned int* remaining;
+          std::condition_variable* done;
+        };
+
+        ThreadPool::ThreadPool (const unsigned int nThreads): stop_ (false)
+        {
+          for (unsigned int k = 0; k < nThreads; ++k) {
+              threads_.push_back (std::thread (&ThreadPool::work, this));
+          }
+        }
+
+        ThreadPool::~ThreadPool ()
+        {
+          {
+            std::lock_guard<std::mutex> lock (mutex_);
+            stop_ = true;
+          }
+          cond_.notify_all ();
+          for (std::size_t k = 0; k < threads_.size (); ++k) {
+              threads_[k].join ();
+          }
+        }
+
+        void ThreadPool::work ()
+        {
+          std::unique_lock<std::mutex> lock (mutex_);
+          while (true) {
+              while (!stop_ && queue_.empty ()) {
+                  cond_.wait (lock);
+              }
+              if (stop_) {
+                  return;
+              }
+              Job* job = queue_.front ();
+              queue_.pop_front ();
+              lock.unlock ();
+              (*job->task) (job->index);
+              lock.lock ();
+              if (--(*job->remaining) == 0) {
+                  job->done->notify_all ();
+              }
+          }
+        }
+
+        void ThreadPool::run (const unsigned int nTasks,
+                const std::function<void (unsigned int)>& task)
+        {
+          if (nTasks == 0) {
+              return;
+          }
+          std::vector<Job> jobs (nTasks);
+          unsigned int remaining = nTasks - 1;
+          std::condition_variable done;
+          {
+            std::lock_guard<std::mutex> lock (mutex_);
+            for (unsigned int k = 1; k < nTasks; ++k) {
+                jobs[k].task = &task;
+                jobs[k].index = k;
+                jobs[k].remaining = &remaining;
+                jobs[k].done = &done;
+                queue_.push_back (&jobs[k]);
+            }
+          }
+          cond_.notify_all ();
+          task (0);
+
+          // help with the jobs of this batch no worker has started yet,
+          // then wait for the others
+          std::unique_lock<std::mutex> lock (mutex_);
+          for (std::deque<Job*>::iterator it = queue_.begin (); it != queue_.end ();) {
+              if ((*it)->remaining == &remaining) {
+                  Job* job = *it;
+                  it = queue_.erase (it);
+                  lock.unlock ();
+                  task (job->index);
+                  lock.lock ();
+                  --remaining;
+                  it = queue_.begin ();
+              } else {
+                  ++it;
+              }
+          }
+          while (remaining > 0) {
+              done.wait (lock);
+          }
+        }
+
+        ThreadPool& ThreadPool::instance ()
+        {
+          static ThreadPool pool (std::max (1u, std::thread::hardware_concurrency ()) - 1);
+          return pool;
+        }
+
+    } // namespace intersect
+} // namespace hpp
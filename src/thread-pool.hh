@@ -0,0 +1,72 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#ifndef HPP_INTERSECT_THREAD_POOL_HH
+#define HPP_INTERSECT_THREAD_POOL_HH
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+
+namespace hpp {
+    namespace intersect {
+
+        /// Fixed set of worker threads running the chunks of a parallel query.
+        /// Several threads may call run () concurrently: their chunks share the queue.
+        class ThreadPool
+        {
+        public:
+          /// Start nThreads worker threads.
+          explicit ThreadPool (const unsigned int nThreads);
+
+          /// Stop and join the worker threads.
+          ~ThreadPool ();
+
+          /// Call task (k) for k in [0, nTasks) and return when all calls are done.
+          /// Task 0 and any tasks not yet picked up by a worker run on the calling
+          /// thread. task must not throw.
+          void run (const unsigned int nTasks, const std::function<void (unsigned int)>& task);
+
+          /// Number of worker threads.
+          unsigned int size () const { return (unsigned int) threads_.size (); }
+
+          /// Pool shared by all queries, with one worker per hardware thread
+          /// besides the calling one. Created on first use.
+          static ThreadPool& instance ();
+
+        private:
+          struct Job;
+
+          void work ();
+
+          std::vector<std::thread> threads_;
+          std::deque<Job*> queue_;
+          std::mutex mutex_;
+          std::condition_variable cond_;
+          bool stop_;
+        };
+
+    } // namespace intersect
+} // namespace hpp
+
+#endif // HPP_INTERSECT_THREAD_POOL_HH
@@ -0,0 +1,84 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#include <hpp/intersect/intersect.hh>
+#include "merge-points.hh"
+#include <Eigen/Geometry>
+#include <algorithm>
+
+namespace hpp {
+    namespace intersect {
+
+        void weldMesh (const BVHModelOB& model, const double tolerance, WeldedMesh& mesh)
+        {
+          // vertices used by the triangles, in the order of their first use
+          std::vector<int> modelIds (model.num_vertices, -1);
+          std::vector<Eigen::Vector3d>& vertices = mesh.vertices_;
+          vertices.clear ();
+          for (int k = 0; k < model.num_tris; ++k) {
+              for (int c = 0; c < 3; ++c) {
+                  const int v = model.tri_indices[k][c];
+                  if (modelIds[v] < 0) {
+                      modelIds[v] = (int) vertices.size ();
+                      vertices.push_back (Eigen::Vector3d (model.vertices[v]));
+                  }
+              }
+          }
+          std::vector<int> table, welded;
+          mergeClosePoints (vertices, tolerance, table, welded);
+
+          mesh.indices_.resize (3 * model.num_tris);
+          mesh.degenerate_.resize (model.num_tris);
+          for (int k = 0; k < model.num_tris; ++k) {
+              int* ids = &mesh.indices_[3*k];
+              for (int c = 0; c < 3; ++c) {
+                  ids[c] = welded[modelIds[model.tri_indices[k][c]]];
+              }
+              // a triangle whose height is below tolerance has no area of its own
+              const Eigen::Vector3d e1 (vertices[ids[1]] - vertices[ids[0]]);
+              const Eigen::Vector3d e2 (vertices[ids[2]] - vertices[ids[0]]);
+              const double longestEdge (std::max (std::max (e1.norm (), e2.norm ()),
+                          (e2 - e1).norm ()));
+              mesh.degenerate_[k] = ids[0] == ids[1] || ids[1] == ids[2] || ids[0] == ids[2] ||
+                  e1.cross (e2).norm () <= tolerance * longestEdge;
+          }
+
+          mesh.min_.setZero ();
+          mesh.max_.setZero ();
+          mesh.center_.setZero ();
+          mesh.radius_ = -1.;
+          if (vertices.empty ()) {
+              return;
+          }
+          mesh.min_ = vertices[0];
+          mesh.max_ = vertices[0];
+          for (std::size_t i = 1; i < vertices.size (); ++i) {
+              mesh.min_ = mesh.min_.cwiseMin (vertices[i]);
+              mesh.max_ = mesh.max_.cwiseMax (vertices[i]);
+          }
+          mesh.center_ = .5 * (mesh.min_ + mesh.max_);
+          double radius2 = 0.;
+          for (std::size_t i = 0; i < vertices.size (); ++i) {
+              radius2 = std::max (radius2, (vertices[i] - mesh.center_).squaredNorm ());
+          }
+          mesh.radius_ = std::sqrt (radius2);
+        }
+
+    } // namespace intersect
+} // namespace hpp
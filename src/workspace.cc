@@ -0,0 +1,52 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#include <hpp/intersect/workspace.hh>
+
+namespace hpp {
+    namespace intersect {
+
+        IntersectionWorkspace::IntersectionWorkspace ():
+            inequality_ (Eigen::MatrixXd (), Eigen::VectorXd (),
+                    Eigen::MatrixXd (), Eigen::MatrixXd ())
+        {}
+
+        void IntersectionWorkspace::clear ()
+        {
+          // swapping with empty containers releases their memory
+          std::vector<Eigen::Vector3d> ().swap (vertices_);
+          std::vector<TrianglePoints> ().swap (triangles_);
+          inequality_ = Inequality (Eigen::MatrixXd (), Eigen::VectorXd (),
+                  Eigen::MatrixXd (), Eigen::MatrixXd ());
+          std::vector<Eigen::Vector3d> ().swap (points_);
+          std::vector<std::vector<Eigen::Vector3d> > ().swap (partial_);
+          std::vector<std::vector<Eigen::Vector3d> > ().swap (polygons_);
+          std::vector<std::pair<int, int> > ().swap (candidates_);
+          std::vector<std::pair<int, int> > ().swap (stack_);
+          std::vector<int> ().swap (vertexIds_);
+          std::vector<Eigen::Vector3d> ().swap (nearVertices_);
+          std::vector<boost::shared_ptr<DistanceTile> > ().swap (tiles_);
+          std::vector<int> ().swap (pointTable_);
+          collisionResult_ = fcl::CollisionResult ();
+          std::vector<Eigen::Vector3d> ().swap (hull_);
+          std::vector<Eigen::Vector3d> ().swap (region_);
+        }
+
+    } // namespace intersect
+} // namespace hpp
@@ -0,0 +1,130 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#define BOOST_TEST_MODULE test-clipping
+#include <boost/test/unit_test.hpp>
+
+#include <hpp/intersect/intersect.hh>
+#include <hpp/intersect/geom/algorithms.h>
+#include <hpp/fcl/collision_object.h>
+#include <Eigen/Geometry>
+
+using namespace hpp::intersect;
+
+// axis aligned box centered on the origin, with half extents half
+BVHModelOB_Ptr_t box (const fcl::Vec3f& half)
+{
+  fcl::Vec3f corners[8];
+  for (int i = 0; i < 8; ++i) {
+      corners[i] = fcl::Vec3f ((i & 1) ? half[0] : -half[0], (i & 2) ? half[1] : -half[1],
+              (i & 4) ? half[2] : -half[2]);
+  }
+  // two triangles per face, oriented outwards
+  static const int faces[12][3] = {{0,2,1}, {1,2,3}, {4,5,6}, {5,7,6}, {0,1,4}, {1,5,4},
+      {2,6,3}, {3,6,7}, {0,4,2}, {2,4,6}, {1,3,5}, {3,7,5}};
+  BVHModelOB_Ptr_t model (new BVHModelOB ());
+  model->beginModel ();
+  for (int k = 0; k < 12; ++k) {
+      model->addTriangle (corners[faces[k][0]], corners[faces[k][1]], corners[faces[k][2]]);
+  }
+  model->endModel ();
+  return model;
+}
+
+// flat grid of n x n squares of side 1 / n in the z = 0 plane, centered on the origin
+BVHModelOB_Ptr_t grid (const int n)
+{
+  BVHModelOB_Ptr_t model (new BVHModelOB ());
+  model->beginModel ();
+  for (int i = 0; i < n; ++i) {
+      for (int j = 0; j < n; ++j) {
+          const fcl::Vec3f p ((double) i / n - .5, (double) j / n - .5, 0.);
+          const fcl::Vec3f dx (1. / n, 0., 0.), dy (0., 1. / n, 0.);
+          model->addTriangle (p, p + dx, p + dx + dy);
+          model->addTriangle (p, p + dx + dy, p + dy);
+      }
+  }
+  model->endModel ();
+  return model;
+}
+
+// true if every point of points is inside the clockwise closed polygon region,
+// or closer than epsilon to it, in the z = 0 plane
+bool insideRegion (const std::vector<Eigen::Vector3d>& points,
+        const std::vector<Eigen::Vector3d>& region, const double epsilon)
+{
+  for (std::size_t i = 0; i < points.size (); ++i) {
+      for (std::size_t k = 0; k + 1 < region.size (); ++k) {
+          const double length ((region[k+1] - region[k]).head<2> ().norm ());
+          if (geom::isLeft<3, double, Eigen::Vector3d, const Eigen::Vector3d&>
+                  (region[k], region[k+1], points[i]) > epsilon * length) {
+              return false;
+          }
+      }
+  }
+  return true;
+}
+
+BOOST_AUTO_TEST_SUITE (test_clipping)
+
+BOOST_AUTO_TEST_CASE (clipping_matches_pair_test)
+{
+  // the rom is a box, hence convex: clipping the affordance triangles against its hull
+  // gives the region of the exact triangle tests
+  fcl::CollisionObjectPtr_t rom (new fcl::CollisionObject (box (fcl::Vec3f (.2, .15, .1))));
+  fcl::CollisionObjectPtr_t affordance (new fcl::CollisionObject (grid (10)));
+  const IntersectionRequest pairs (BVH_TRAVERSAL);
+  const IntersectionRequest clipping (CONVEX_CLIPPING);
+  std::vector<Eigen::Matrix3d> rotations;
+  rotations.push_back (Eigen::Matrix3d::Identity ());
+  rotations.push_back (Eigen::AngleAxisd (.3, Eigen::Vector3d::UnitZ ()).toRotationMatrix ());
+  rotations.push_back (Eigen::AngleAxisd (.7, Eigen::Vector3d (1., 2., .5).normalized ())
+          .toRotationMatrix ());
+  rotations.push_back (Eigen::AngleAxisd (1.2, Eigen::Vector3d (-.3, .4, 1.).normalized ())
+          .toRotationMatrix ());
+  std::vector<fcl::Vec3f> positions;
+  positions.push_back (fcl::Vec3f (0., 0., 0.));
+  positions.push_back (fcl::Vec3f (.13, -.07, .05));
+  positions.push_back (fcl::Vec3f (-.41, .37, -.08));
+  // pose whose region only holds affordance vertices inside the rom
+  positions.push_back (fcl::Vec3f (.02, .03, 0.));
+  for (std::size_t r = 0; r < rotations.size (); ++r) {
+      for (std::size_t k = 0; k < positions.size (); ++k) {
+          rom->setRotation (rotations[r]);
+          rom->setTranslation (positions[k]);
+          rom->computeAABB ();
+          const std::vector<Eigen::Vector3d> expected (getIntersectionPoints (rom, affordance,
+                      pairs));
+          const std::vector<Eigen::Vector3d> region (getIntersectionPoints (rom, affordance,
+                      clipping));
+          BOOST_CHECK (!expected.empty ());
+          BOOST_CHECK_EQUAL (region.empty (), expected.empty ());
+          BOOST_CHECK (insideRegion (region, expected, 1e-6));
+          BOOST_CHECK (insideRegion (expected, region, 1e-6));
+      }
+  }
+  // out of contact
+  rom->setRotation (Eigen::Matrix3d::Identity ());
+  rom->setTranslation (fcl::Vec3f (0., 0., .5));
+  rom->computeAABB ();
+  BOOST_CHECK (getIntersectionPoints (rom, affordance, pairs).empty ());
+  BOOST_CHECK (getIntersectionPoints (rom, affordance, clipping).empty ());
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
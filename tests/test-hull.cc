@@ -0,0 +1,240 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#define BOOST_TEST_MODULE test-hull
+#include <boost/test/unit_test.hpp>
+
+#include <hpp/intersect/geom/algorithms.h>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+typedef std::vector<Eigen::Vector3d> Points_t;
+
+// uniform random number in [-1, 1]
+double random11 ()
+{
+  return 2. * std::rand () / (double) RAND_MAX - 1.;
+}
+
+// n x n grid of step 1 / n in the z = 0 plane, each point moved by at most jitter
+Points_t grid (const int n, const double jitter)
+{
+  Points_t points;
+  for (int i = 0; i < n; ++i) {
+      for (int j = 0; j < n; ++j) {
+          points.push_back (Eigen::Vector3d ((double) i / n + jitter * random11 (),
+                      (double) j / n + jitter * random11 (), 0.));
+      }
+  }
+  return points;
+}
+
+// true if hull is closed and no point is on the left of one of its edges by more than epsilon,
+// i.e. the clockwise polygon contains all the points
+bool containsAll (const Points_t& hull, const Points_t& points, const double epsilon)
+{
+  if (hull.empty () || hull.front () != hull.back ()) {
+      return false;
+  }
+  for (std::size_t k = 0; k + 1 < hull.size (); ++k) {
+      for (std::size_t i = 0; i < points.size (); ++i) {
+          if (geom::isLeft<3, double, Eigen::Vector3d, const Eigen::Vector3d&>
+                  (hull[k], hull[k+1], points[i]) > epsilon) {
+              return false;
+          }
+      }
+  }
+  return true;
+}
+
+// vertices of the 2D convex hull of points, by brute force: (a, b) is a clockwise hull edge if
+// no point is on its left and the points on its line lie between a and b.
+// Vertices are returned in lexicographic order, each once.
+Points_t referenceVertices (const Points_t& points)
+{
+  Points_t vertices;
+  for (std::size_t a = 0; a < points.size (); ++a) {
+      for (std::size_t b = 0; b < points.size (); ++b) {
+          const Eigen::Vector2d ab ((points[b] - points[a]).head<2> ());
+          if (ab.squaredNorm () == 0.) {
+              continue;
+          }
+          bool edge = true;
+          for (std::size_t i = 0; i < points.size () && edge; ++i) {
+              const double turn (geom::isLeft<3, double, Eigen::Vector3d, const Eigen::Vector3d&>
+                      (points[a], points[b], points[i]));
+              const double t (ab.dot ((points[i] - points[a]).head<2> ()));
+              edge = turn < 0. || (turn == 0. && t >= 0. && t <= ab.squaredNorm ());
+          }
+          if (edge) {
+              vertices.push_back (points[a]);
+              vertices.push_back (points[b]);
+          }
+      }
+  }
+  if (vertices.empty () && !points.empty ()) {
+      vertices.push_back (points.front ());
+  }
+  std::sort (vertices.begin (), vertices.end (),
+          geom::lexicographicLess<3, const Eigen::Vector3d&>);
+  vertices.erase (std::unique (vertices.begin (), vertices.end ()), vertices.end ());
+  return vertices;
+}
+
+// vertices of a closed hull in lexicographic order, each once
+Points_t sortedVertices (const Points_t& hull)
+{
+  Points_t vertices (hull.begin (), hull.end () - 1);
+  std::sort (vertices.begin (), vertices.end (),
+          geom::lexicographicLess<3, const Eigen::Vector3d&>);
+  vertices.erase (std::unique (vertices.begin (), vertices.end ()), vertices.end ());
+  return vertices;
+}
+
+BOOST_AUTO_TEST_SUITE (test_hull)
+
+BOOST_AUTO_TEST_CASE (gift_wrap_collinear_edges)
+{
+  // grid points lie on the edges of their hull: only the corners are hull vertices
+  Points_t points (grid (5, 0.));
+  Points_t hull (geom::convexHull<Points_t> (points.begin (), points.end ()));
+  BOOST_CHECK_EQUAL (hull.size (), 5u);
+  BOOST_CHECK (containsAll (hull, points, 0.));
+  BOOST_CHECK (sortedVertices (hull) == referenceVertices (points));
+
+  // a point in the middle of the left edge is not the first hull vertex
+  points.clear ();
+  points.push_back (Eigen::Vector3d (-1., 0., 0.));
+  points.push_back (Eigen::Vector3d (-1., -1., 0.));
+  points.push_back (Eigen::Vector3d (-1., .5, 0.));
+  points.push_back (Eigen::Vector3d (1., 1., 0.));
+  points.push_back (Eigen::Vector3d (1., -1., 0.));
+  points.push_back (Eigen::Vector3d (0., 0., 0.));
+  hull = geom::convexHull<Points_t> (points.begin (), points.end ());
+  BOOST_CHECK (hull.front () == points[1]);
+  BOOST_CHECK (containsAll (hull, points, 0.));
+  BOOST_CHECK (sortedVertices (hull) == referenceVertices (points));
+}
+
+BOOST_AUTO_TEST_CASE (gift_wrap_random_points)
+{
+  std::srand (0);
+  for (int trial = 0; trial < 50; ++trial) {
+      Points_t points;
+      const int n (3 + std::rand () % 40);
+      for (int i = 0; i < n; ++i) {
+          points.push_back (Eigen::Vector3d (random11 (), random11 (), 0.));
+      }
+      const Points_t hull (geom::convexHull<Points_t> (points.begin (), points.end ()));
+      BOOST_CHECK (containsAll (hull, points, 0.));
+      BOOST_CHECK (sortedVertices (hull) == referenceVertices (points));
+  }
+}
+
+BOOST_AUTO_TEST_CASE (gift_wrap_near_duplicates)
+{
+  // points closer than any tolerance used to make the walk cycle without coming back
+  // to its first point: the hull must still be closed and have at most one vertex per point
+  std::srand (1);
+  for (int trial = 0; trial < 5; ++trial) {
+      Points_t points (grid (28, 1e-7));
+      const std::size_t n (points.size ());
+      for (std::size_t i = 0; i < n; ++i) {
+          points.push_back (points[i] + Eigen::Vector3d (1e-7 * random11 (), 1e-7 * random11 (), 0.));
+      }
+      const Points_t hull (geom::convexHull<Points_t> (points.begin (), points.end ()));
+      BOOST_CHECK (hull.size () <= points.size () + 1);
+      BOOST_CHECK (containsAll (hull, points, 1e-12));
+  }
+}
+
+// checks that hull is the closed clockwise hull of points starting from its lowest leftmost
+// vertex, with the vertices of the brute force hull only, and that it does not depend on
+// the order of the points
+void checkMonotoneChain (Points_t points)
+{
+  const Points_t hull (geom::monotoneChainHull<Points_t> (points.begin (), points.end ()));
+  const Points_t vertices (referenceVertices (points));
+  BOOST_CHECK_EQUAL (hull.size (), vertices.size () + 1);
+  BOOST_CHECK (sortedVertices (hull) == vertices);
+  BOOST_CHECK (hull.front () == vertices.front ());
+  BOOST_CHECK (containsAll (hull, points, 0.));
+  for (int trial = 0; trial < 5; ++trial) {
+      std::random_shuffle (points.begin (), points.end ());
+      BOOST_CHECK (geom::monotoneChainHull<Points_t> (points.begin (), points.end ()) == hull);
+  }
+}
+
+BOOST_AUTO_TEST_CASE (monotone_chain_degenerate_inputs)
+{
+  std::srand (2);
+  Points_t points;
+  // single point, then the same point several times
+  points.push_back (Eigen::Vector3d (.3, -.2, 0.));
+  checkMonotoneChain (points);
+  points.push_back (points.front ());
+  points.push_back (points.front ());
+  checkMonotoneChain (points);
+
+  // all points on one line, some of them duplicated
+  points.clear ();
+  for (int i = 0; i < 7; ++i) {
+      points.push_back (Eigen::Vector3d (.5 * i - 1., .25 * i, 0.));
+  }
+  points.push_back (points[3]);
+  points.push_back (points[6]);
+  checkMonotoneChain (points);
+  Points_t hull (geom::monotoneChainHull<Points_t> (points.begin (), points.end ()));
+  BOOST_CHECK_EQUAL (hull.size (), 3u);
+
+  // vertical line: ties on x are broken by y
+  points.clear ();
+  for (int i = 0; i < 5; ++i) {
+      points.push_back (Eigen::Vector3d (1., 2. - i, 0.));
+  }
+  checkMonotoneChain (points);
+
+  // square with points in the middle of its edges, duplicated corners and inner points
+  points = grid (5, 0.);
+  points.push_back (points.front ());
+  points.push_back (points.back ());
+  checkMonotoneChain (points);
+  hull = geom::monotoneChainHull<Points_t> (points.begin (), points.end ());
+  BOOST_CHECK_EQUAL (hull.size (), 5u);
+}
+
+BOOST_AUTO_TEST_CASE (monotone_chain_random_points)
+{
+  std::srand (3);
+  for (int trial = 0; trial < 50; ++trial) {
+      Points_t points;
+      const int n (1 + std::rand () % 40);
+      for (int i = 0; i < n; ++i) {
+          // coordinates on a coarse lattice give many duplicate and collinear points
+          points.push_back (Eigen::Vector3d ((std::rand () % 9 - 4) / 4.,
+                      (std::rand () % 9 - 4) / 4., 0.));
+      }
+      checkMonotoneChain (points);
+      const Points_t giftWrap (geom::convexHull<Points_t> (points.begin (), points.end ()));
+      BOOST_CHECK (sortedVertices (giftWrap) == referenceVertices (points));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,198 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#define BOOST_TEST_MODULE test-pairs
+#include <boost/test/unit_test.hpp>
+
+#include <hpp/intersect/intersect.hh>
+#include <hpp/intersect/geom/algorithms.h>
+#include <hpp/fcl/collision_object.h>
+#include <Eigen/Geometry>
+#include <cmath>
+
+using namespace hpp::intersect;
+
+typedef std::vector<Eigen::Vector3d> Points_t;
+
+// axis aligned box centered on the origin, with half extents half
+BVHModelOB_Ptr_t box (const fcl::Vec3f& half)
+{
+  fcl::Vec3f corners[8];
+  for (int i = 0; i < 8; ++i) {
+      corners[i] = fcl::Vec3f ((i & 1) ? half[0] : -half[0], (i & 2) ? half[1] : -half[1],
+              (i & 4) ? half[2] : -half[2]);
+  }
+  // two triangles per face, oriented outwards
+  static const int faces[12][3] = {{0,2,1}, {1,2,3}, {4,5,6}, {5,7,6}, {0,1,4}, {1,5,4},
+      {2,6,3}, {3,6,7}, {0,4,2}, {2,4,6}, {1,3,5}, {3,7,5}};
+  BVHModelOB_Ptr_t model (new BVHModelOB ());
+  model->beginModel ();
+  for (int k = 0; k < 12; ++k) {
+      model->addTriangle (corners[faces[k][0]], corners[faces[k][1]], corners[faces[k][2]]);
+  }
+  model->endModel ();
+  return model;
+}
+
+// height field of n x n squares of side 1 / n, centered on the origin, of height
+// amplitude * sin (6x) cos (5y): flat if amplitude is 0
+BVHModelOB_Ptr_t terrain (const int n, const double amplitude)
+{
+  BVHModelOB_Ptr_t model (new BVHModelOB ());
+  model->beginModel ();
+  for (int i = 0; i < n; ++i) {
+      for (int j = 0; j < n; ++j) {
+          fcl::Vec3f p[4];
+          for (int c = 0; c < 4; ++c) {
+              const double x ((double) (i + (c == 1 || c == 2)) / n - .5);
+              const double y ((double) (j + (c >= 2)) / n - .5);
+              p[c] = fcl::Vec3f (x, y, amplitude * std::sin (6. * x) * std::cos (5. * y));
+          }
+          model->addTriangle (p[0], p[1], p[2]);
+          model->addTriangle (p[0], p[2], p[3]);
+      }
+  }
+  model->endModel ();
+  return model;
+}
+
+// points where an edge of triangle t crosses the plane of triangle s inside s
+void edgeCrossings (const TrianglePoints& t, const TrianglePoints& s, Points_t& points)
+{
+  const Eigen::Vector3d s1 (s.p1), s2 (s.p2), s3 (s.p3);
+  const Eigen::Vector3d n ((s2 - s1).cross (s3 - s1));
+  const Eigen::Vector3d corners[3] = {t.p1, t.p2, t.p3};
+  for (int e = 0; e < 3; ++e) {
+      const Eigen::Vector3d& a = corners[e];
+      const Eigen::Vector3d& b = corners[(e + 1) % 3];
+      const double da (n.dot (a - s1)), db (n.dot (b - s1));
+      if ((da > 0. && db > 0.) || (da < 0. && db < 0.) || da == db) {
+          continue;
+      }
+      const Eigen::Vector3d x (a + da / (da - db) * (b - a));
+      const double epsilon (1e-12 * n.squaredNorm ());
+      if (n.dot ((s2 - s1).cross (x - s1)) >= -epsilon &&
+              n.dot ((s3 - s2).cross (x - s2)) >= -epsilon &&
+              n.dot ((s1 - s3).cross (x - s3)) >= -epsilon) {
+          points.push_back (x);
+      }
+  }
+}
+
+// contact region by brute force: the affordance vertices inside the convex rom and the
+// ends of the intersection segments of all n x m triangle pairs
+Points_t referenceRegion (const fcl::CollisionObjectPtr_t& rom,
+        const fcl::CollisionObjectPtr_t& affordance)
+{
+  std::vector<TrianglePoints> romTris, affTris;
+  getWorldTriangles (rom, romTris);
+  getWorldTriangles (affordance, affTris);
+  const Inequality ineq (fcl2inequalities (rom));
+  Points_t points;
+  for (std::size_t i = 0; i < affTris.size (); ++i) {
+      const fcl::Vec3f* corners[3] = {&affTris[i].p1, &affTris[i].p2, &affTris[i].p3};
+      for (int c = 0; c < 3; ++c) {
+          if (is_inside (ineq, Eigen::Vector3d (*corners[c]))) {
+              points.push_back (*corners[c]);
+          }
+      }
+      for (std::size_t j = 0; j < romTris.size (); ++j) {
+          edgeCrossings (affTris[i], romTris[j], points);
+          edgeCrossings (romTris[j], affTris[i], points);
+      }
+  }
+  Points_t hull;
+  if (!points.empty ()) {
+      geom::monotoneChainHull<Points_t> (points.begin (), points.end (), hull);
+  }
+  return hull;
+}
+
+// true if every point of points is inside the clockwise closed polygon region,
+// or closer than epsilon to it, in the z = 0 plane
+bool insideRegion (const Points_t& points, const Points_t& region, const double epsilon)
+{
+  for (std::size_t i = 0; i < points.size (); ++i) {
+      for (std::size_t k = 0; k + 1 < region.size (); ++k) {
+          const double length ((region[k+1] - region[k]).head<2> ().norm ());
+          if (geom::isLeft<3, double, Eigen::Vector3d, const Eigen::Vector3d&>
+                  (region[k], region[k+1], points[i]) > epsilon * length) {
+              return false;
+          }
+      }
+  }
+  return true;
+}
+
+// checks that both pair selections give the brute force region of the rom at its pose
+void checkPairSelections (const fcl::CollisionObjectPtr_t& rom,
+        const fcl::CollisionObjectPtr_t& affordance)
+{
+  rom->computeAABB ();
+  const Points_t expected (referenceRegion (rom, affordance));
+  BOOST_REQUIRE (expected.size () > 3);
+  const PairSelection selections[2] = {BVH_TRAVERSAL, FCL_CONTACTS};
+  for (int s = 0; s < 2; ++s) {
+      const Points_t region (getIntersectionPoints (rom, affordance,
+                  IntersectionRequest (selections[s])));
+      BOOST_CHECK (region.size () >= 3);
+      BOOST_CHECK (insideRegion (region, expected, 1e-5));
+      BOOST_CHECK (insideRegion (expected, region, 1e-5));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE (test_pairs)
+
+BOOST_AUTO_TEST_CASE (pair_selections_match_brute_force)
+{
+  fcl::CollisionObjectPtr_t rom (new fcl::CollisionObject (box (fcl::Vec3f (.2, .15, .1))));
+  fcl::CollisionObjectPtr_t affordance (new fcl::CollisionObject (terrain (12, .03)));
+  std::vector<Eigen::Matrix3d> rotations;
+  rotations.push_back (Eigen::Matrix3d::Identity ());
+  rotations.push_back (Eigen::AngleAxisd (.7, Eigen::Vector3d (1., 2., .5).normalized ())
+          .toRotationMatrix ());
+  rotations.push_back (Eigen::AngleAxisd (1.2, Eigen::Vector3d (-.3, .4, 1.).normalized ())
+          .toRotationMatrix ());
+  std::vector<fcl::Vec3f> positions;
+  positions.push_back (fcl::Vec3f (0., 0., 0.));
+  positions.push_back (fcl::Vec3f (.1, -.05, .02));
+  positions.push_back (fcl::Vec3f (-.3, .25, -.05));
+  for (std::size_t r = 0; r < rotations.size (); ++r) {
+      for (std::size_t k = 0; k < positions.size (); ++k) {
+          rom->setRotation (rotations[r]);
+          rom->setTranslation (positions[k]);
+          checkPairSelections (rom, affordance);
+      }
+  }
+}
+
+BOOST_AUTO_TEST_CASE (grazing_contact)
+{
+  // a box edge dips 1e-4 below a flat affordance: the region is a thin strip
+  // along the edge, made of intersection segments only
+  fcl::CollisionObjectPtr_t rom (new fcl::CollisionObject (box (fcl::Vec3f (.2, .15, .1))));
+  fcl::CollisionObjectPtr_t affordance (new fcl::CollisionObject (terrain (12, 0.)));
+  const double angle (M_PI / 4.);
+  rom->setRotation (Eigen::AngleAxisd (angle, Eigen::Vector3d::UnitX ()).toRotationMatrix ());
+  rom->setTranslation (fcl::Vec3f (.03, .02,
+              .15 * std::sin (angle) + .1 * std::cos (angle) - 1e-4));
+  checkPairSelections (rom, affordance);
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,151 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#define BOOST_TEST_MODULE test-query-context
+#include <boost/test/unit_test.hpp>
+
+#include <hpp/intersect/intersect.hh>
+#include <hpp/intersect/cache.hh>
+#include <hpp/intersect/workspace.hh>
+#include <hpp/intersect/query-context.hh>
+#include <hpp/fcl/collision_object.h>
+#include <Eigen/Geometry>
+#include <cmath>
+
+using namespace hpp::intersect;
+
+typedef std::vector<Eigen::Vector3d> Points_t;
+
+// axis aligned box centered on the origin, with half extents half
+BVHModelOB_Ptr_t box (const fcl::Vec3f& half)
+{
+  fcl::Vec3f corners[8];
+  for (int i = 0; i < 8; ++i) {
+      corners[i] = fcl::Vec3f ((i & 1) ? half[0] : -half[0], (i & 2) ? half[1] : -half[1],
+              (i & 4) ? half[2] : -half[2]);
+  }
+  // two triangles per face, oriented outwards
+  static const int faces[12][3] = {{0,2,1}, {1,2,3}, {4,5,6}, {5,7,6}, {0,1,4}, {1,5,4},
+      {2,6,3}, {3,6,7}, {0,4,2}, {2,4,6}, {1,3,5}, {3,7,5}};
+  BVHModelOB_Ptr_t model (new BVHModelOB ());
+  model->beginModel ();
+  for (int k = 0; k < 12; ++k) {
+      model->addTriangle (corners[faces[k][0]], corners[faces[k][1]], corners[faces[k][2]]);
+  }
+  model->endModel ();
+  return model;
+}
+
+// flat grid of n x n squares of side 1 / n in the z = 0 plane, centered on the origin
+BVHModelOB_Ptr_t grid (const int n)
+{
+  BVHModelOB_Ptr_t model (new BVHModelOB ());
+  model->beginModel ();
+  for (int i = 0; i < n; ++i) {
+      for (int j = 0; j < n; ++j) {
+          const fcl::Vec3f p ((double) i / n - .5, (double) j / n - .5, 0.);
+          const fcl::Vec3f dx (1. / n, 0., 0.), dy (0., 1. / n, 0.);
+          model->addTriangle (p, p + dx, p + dx + dy);
+          model->addTriangle (p, p + dx + dy, p + dy);
+      }
+  }
+  model->endModel ();
+  return model;
+}
+
+BOOST_AUTO_TEST_SUITE (test_query_context)
+
+BOOST_AUTO_TEST_CASE (reuse_within_margin)
+{
+  const fcl::Vec3f half (.2, .15, .1);
+  const BVHModelOBConst_Ptr_t rom (box (half)), aff (grid (4)), other (grid (4));
+  QueryContext context (1e-2);
+  const fcl::Matrix3f I (Eigen::Matrix3d::Identity ());
+  const fcl::Vec3f origin (0., 0., 0.);
+  context.setModels (rom, aff);
+  BOOST_CHECK (!context.reuse (I, origin));
+  context.store (I, origin, std::vector<std::pair<int, int> > (1, std::make_pair (0, 1)),
+          std::vector<int> (1, 2));
+  BOOST_CHECK_EQUAL (context.traversals (), 1u);
+
+  // translations inside and outside the margin
+  BOOST_CHECK (context.reuse (I, fcl::Vec3f (6e-3, -6e-3, 0.)));
+  BOOST_CHECK (!context.reuse (I, fcl::Vec3f (1.2e-2, 0., 0.)));
+  // a rotation by angle moves the farthest point of the rom, at the distance of a
+  // corner of the box, by about angle times that distance
+  const double radius (half.norm ());
+  const double angle (.5e-2 / radius);
+  BOOST_CHECK (context.reuse (fcl::Matrix3f (Eigen::AngleAxisd (angle, Eigen::Vector3d::UnitZ ())
+                  .toRotationMatrix ()), origin));
+  BOOST_CHECK (!context.reuse (fcl::Matrix3f (Eigen::AngleAxisd (4. * angle,
+                      Eigen::Vector3d::UnitZ ()).toRotationMatrix ()), origin));
+  BOOST_CHECK_EQUAL (context.reuses (), 2u);
+  BOOST_CHECK_EQUAL (context.pairs ().size (), 1u);
+  BOOST_CHECK_EQUAL (context.vertices ().size (), 1u);
+
+  // the same models keep the pairs, other models or a reset drop them
+  context.setModels (rom, aff);
+  BOOST_CHECK (context.reuse (I, origin));
+  context.setModels (rom, other);
+  BOOST_CHECK (!context.reuse (I, origin));
+  BOOST_CHECK (context.pairs ().empty ());
+  context.setModels (rom, aff);
+  context.store (I, origin, std::vector<std::pair<int, int> > (), std::vector<int> ());
+  context.reset ();
+  BOOST_CHECK (!context.reuse (I, origin));
+}
+
+BOOST_AUTO_TEST_CASE (trajectory)
+{
+  // a rom moving by small steps over a grid reuses the pairs of the last traversal
+  // while it stays within the margin, and gives the region of a query without context
+  fcl::CollisionObjectPtr_t rom (new fcl::CollisionObject (box (fcl::Vec3f (.2, .15, .1))));
+  fcl::CollisionObjectPtr_t affordance (new fcl::CollisionObject (grid (10)));
+  MeshCache cache;
+  IntersectionWorkspace workspace;
+  QueryContext context (2e-2);
+  const int nSteps (40);
+  std::size_t traversals (0);
+  for (int k = 0; k < nSteps; ++k) {
+      // steps of 4 mm: a traversal every 5 steps at most; a jump of 20 cm half way
+      const double x (-.1 + 4e-3 * k + (k >= nSteps / 2 ? .2 : 0.));
+      rom->setRotation (Eigen::AngleAxisd (.01 * k, Eigen::Vector3d::UnitZ ()).toRotationMatrix ());
+      rom->setTranslation (fcl::Vec3f (x, .03, .02));
+      rom->computeAABB ();
+      const std::size_t before (context.traversals ());
+      const Points_t region (getIntersectionPoints (rom, affordance, cache, workspace, context));
+      const Points_t expected (getIntersectionPoints (rom, affordance));
+      BOOST_CHECK_EQUAL (region.size (), expected.size ());
+      for (std::size_t i = 0; i < std::min (region.size (), expected.size ()); ++i) {
+          BOOST_CHECK ((region[i] - expected[i]).norm () < 1e-9);
+      }
+      if (context.traversals () > before) {
+          ++traversals;
+      }
+      // the first query and the one after the jump traverse the hierarchies
+      if (k == 0 || k == nSteps / 2) {
+          BOOST_CHECK_EQUAL (context.traversals (), before + 1);
+      }
+  }
+  BOOST_CHECK_EQUAL (context.traversals () + context.reuses (), (std::size_t) nSteps);
+  BOOST_CHECK (context.reuses () > 0);
+  BOOST_CHECK (traversals < (std::size_t) nSteps / 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,183 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#define BOOST_TEST_MODULE test-quickhull
+#include <boost/test/unit_test.hpp>
+
+#include <hpp/intersect/intersect.hh>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+using namespace hpp::intersect;
+
+typedef std::vector<TrianglePoints> Triangles_t;
+
+// uniform random number in [-1, 1]
+double random11 ()
+{
+  return 2. * std::rand () / (double) RAND_MAX - 1.;
+}
+
+TrianglePoints triangle (const fcl::Vec3f& p1, const fcl::Vec3f& p2, const fcl::Vec3f& p3)
+{
+  TrianglePoints tri;
+  tri.p1 = p1;
+  tri.p2 = p2;
+  tri.p3 = p3;
+  return tri;
+}
+
+// triangles of the faces of the cube [-half, half]^3, each face split into n x n squares:
+// the triangles of a face are coplanar
+Triangles_t cube (const double half, const int n)
+{
+  Triangles_t triangles;
+  for (int axis = 0; axis < 3; ++axis) {
+      const int u ((axis + 1) % 3), v ((axis + 2) % 3);
+      for (int side = -1; side <= 1; side += 2) {
+          for (int i = 0; i < n; ++i) {
+              for (int j = 0; j < n; ++j) {
+                  fcl::Vec3f p[4];
+                  for (int c = 0; c < 4; ++c) {
+                      p[c][axis] = side * half;
+                      p[c][u] = half * (2. * (i + (c == 1 || c == 2)) / n - 1.);
+                      p[c][v] = half * (2. * (j + (c >= 2)) / n - 1.);
+                  }
+                  triangles.push_back (triangle (p[0], p[1], p[2]));
+                  triangles.push_back (triangle (p[0], p[2], p[3]));
+              }
+          }
+      }
+  }
+  return triangles;
+}
+
+// largest violation of the inequalities by the corners of the triangles
+double maxViolation (const Inequality& ineq, const Triangles_t& triangles)
+{
+  double res (-std::numeric_limits<double>::infinity ());
+  for (std::size_t k = 0; k < triangles.size (); ++k) {
+      const fcl::Vec3f* corners[3] = {&triangles[k].p1, &triangles[k].p2, &triangles[k].p3};
+      for (int c = 0; c < 3; ++c) {
+          res = std::max (res, (ineq.A_ * Eigen::Vector3d (*corners[c]) - ineq.b_).maxCoeff ());
+      }
+  }
+  return res;
+}
+
+// true if every plane of ineq has a unit normal and goes through a corner of the triangles
+bool tightPlanes (const Inequality& ineq, const Triangles_t& triangles, const double epsilon)
+{
+  for (int r = 0; r < ineq.A_.rows (); ++r) {
+      if (std::fabs (ineq.A_.row (r).norm () - 1.) > epsilon) {
+          return false;
+      }
+      double gap (std::numeric_limits<double>::infinity ());
+      for (std::size_t k = 0; k < triangles.size (); ++k) {
+          const fcl::Vec3f* corners[3] = {&triangles[k].p1, &triangles[k].p2, &triangles[k].p3};
+          for (int c = 0; c < 3; ++c) {
+              gap = std::min (gap, std::fabs (ineq.A_.row (r).dot (Eigen::Vector3d (*corners[c])) -
+                          ineq.b_ (r)));
+          }
+      }
+      if (gap > epsilon) {
+          return false;
+      }
+  }
+  return true;
+}
+
+Inequality hull (const Triangles_t& triangles)
+{
+  const Eigen::MatrixXd empty;
+  Inequality ineq (empty, Eigen::VectorXd (), empty, empty);
+  convexHullInequalities (triangles, ineq);
+  return ineq;
+}
+
+BOOST_AUTO_TEST_SUITE (test_quickhull)
+
+BOOST_AUTO_TEST_CASE (cube_with_coplanar_facets)
+{
+  // the triangles of a face merge into one plane, whatever the subdivision
+  for (int n = 1; n <= 4; ++n) {
+      const Triangles_t triangles (cube (.5, n));
+      const Inequality ineq (hull (triangles));
+      BOOST_CHECK_EQUAL (ineq.A_.rows (), 6);
+      BOOST_CHECK (maxViolation (ineq, triangles) < 1e-12);
+      BOOST_CHECK (tightPlanes (ineq, triangles, 1e-12));
+  }
+}
+
+BOOST_AUTO_TEST_CASE (points_inside)
+{
+  // triangles inside the cube add no plane
+  std::srand (0);
+  Triangles_t triangles (cube (1., 1));
+  for (int k = 0; k < 50; ++k) {
+      triangles.push_back (triangle (fcl::Vec3f (random11 (), random11 (), random11 ()) * .9,
+                  fcl::Vec3f (random11 (), random11 (), random11 ()) * .9,
+                  fcl::Vec3f (random11 (), random11 (), random11 ()) * .9));
+  }
+  const Inequality ineq (hull (triangles));
+  BOOST_CHECK_EQUAL (ineq.A_.rows (), 6);
+  BOOST_CHECK (maxViolation (ineq, triangles) < 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE (sphere)
+{
+  // every point of a sphere is a hull vertex: each corner lies on a plane,
+  // and no corner is outside the hull
+  std::srand (1);
+  Triangles_t triangles;
+  for (int k = 0; k < 200; ++k) {
+      fcl::Vec3f p[3];
+      for (int c = 0; c < 3; ++c) {
+          Eigen::Vector3d d;
+          do {
+              d = Eigen::Vector3d (random11 (), random11 (), random11 ());
+          } while (d.norm () < .1 || d.norm () > 1.);
+          p[c] = fcl::Vec3f (2. * d.normalized ());
+      }
+      triangles.push_back (triangle (p[0], p[1], p[2]));
+  }
+  const Inequality ineq (hull (triangles));
+  BOOST_CHECK (ineq.A_.rows () >= 4);
+  BOOST_CHECK (maxViolation (ineq, triangles) < 1e-9);
+  BOOST_CHECK (tightPlanes (ineq, triangles, 1e-9));
+  for (std::size_t k = 0; k < triangles.size (); ++k) {
+      BOOST_CHECK ((ineq.A_ * Eigen::Vector3d (triangles[k].p1) - ineq.b_).maxCoeff () > -1e-9);
+  }
+}
+
+BOOST_AUTO_TEST_CASE (flat_object)
+{
+  // triangles in one plane bound no volume: one row per triangle, as fcl2inequalities
+  const Triangles_t square (cube (.5, 2));
+  Triangles_t triangles (square.begin (), square.begin () + 8);
+  const Inequality ineq (hull (triangles));
+  const Inequality planes (fcl2inequalities (triangles));
+  BOOST_CHECK_EQUAL (ineq.A_.rows (), 8);
+  BOOST_CHECK (ineq.A_.isApprox (planes.A_));
+  BOOST_CHECK (ineq.b_.isApprox (planes.b_));
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,166 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#define BOOST_TEST_MODULE test-result-cache
+#include <boost/test/unit_test.hpp>
+
+#include <hpp/intersect/result-cache.hh>
+#include <Eigen/Geometry>
+
+using namespace hpp::intersect;
+
+typedef std::vector<Eigen::Vector3d> Points_t;
+
+// the cache never reads the triangles of a model: only its identity matters
+BVHModelOBConst_Ptr_t model ()
+{
+  BVHModelOB_Ptr_t model (new BVHModelOB ());
+  model->beginModel ();
+  model->addTriangle (fcl::Vec3f (0., 0., 0.), fcl::Vec3f (1., 0., 0.), fcl::Vec3f (0., 1., 0.));
+  model->endModel ();
+  return model;
+}
+
+fcl::Transform3f pose (const Eigen::Matrix3d& R, const Eigen::Vector3d& T)
+{
+  return fcl::Transform3f (fcl::Matrix3f (R), fcl::Vec3f (T));
+}
+
+Points_t square (const double side)
+{
+  Points_t region;
+  region.push_back (Eigen::Vector3d (0., 0., 0.));
+  region.push_back (Eigen::Vector3d (0., side, 0.));
+  region.push_back (Eigen::Vector3d (side, side, 0.));
+  region.push_back (Eigen::Vector3d (side, 0., 0.));
+  region.push_back (Eigen::Vector3d (0., 0., 0.));
+  return region;
+}
+
+bool sameRegion (const Points_t& a, const Points_t& b, const double epsilon)
+{
+  if (a.size () != b.size ()) {
+      return false;
+  }
+  for (std::size_t i = 0; i < a.size (); ++i) {
+      if ((a[i] - b[i]).norm () > epsilon) {
+          return false;
+      }
+  }
+  return true;
+}
+
+BOOST_AUTO_TEST_SUITE (test_result_cache)
+
+BOOST_AUTO_TEST_CASE (quantised_pose)
+{
+  ResultCache cache (16, 1e-2, 1e-2, 1);
+  const BVHModelOBConst_Ptr_t rom (model ()), aff (model ());
+  const Eigen::Matrix3d I (Eigen::Matrix3d::Identity ());
+  const Eigen::Vector3d affT (.3, -.2, .1);
+  const Points_t region (square (.1));
+  Points_t found;
+  BOOST_CHECK (!cache.find (rom, pose (I, Eigen::Vector3d::Zero ()), aff, pose (I, affT), found));
+  cache.insert (rom, pose (I, Eigen::Vector3d::Zero ()), aff, pose (I, affT), region);
+  BOOST_CHECK_EQUAL (cache.size (), 1u);
+
+  // same cell: less than half a step away in translation and in rotation
+  BOOST_CHECK (cache.find (rom, pose (I, Eigen::Vector3d::Zero ()), aff,
+              pose (I, affT + Eigen::Vector3d (3e-3, -3e-3, 2e-3)), found));
+  BOOST_CHECK (sameRegion (found, region, 1e-12));
+  const Eigen::Matrix3d small (Eigen::AngleAxisd (3e-3, Eigen::Vector3d::UnitZ ())
+          .toRotationMatrix ());
+  BOOST_CHECK (cache.find (rom, pose (I, Eigen::Vector3d::Zero ()), aff, pose (small, affT),
+              found));
+
+  // past the quantum
+  BOOST_CHECK (!cache.find (rom, pose (I, Eigen::Vector3d::Zero ()), aff,
+              pose (I, affT + Eigen::Vector3d (1.2e-2, 0., 0.)), found));
+  const Eigen::Matrix3d large (Eigen::AngleAxisd (3e-2, Eigen::Vector3d::UnitZ ())
+          .toRotationMatrix ());
+  BOOST_CHECK (!cache.find (rom, pose (I, Eigen::Vector3d::Zero ()), aff, pose (large, affT),
+              found));
+  // another pair of models
+  BOOST_CHECK (!cache.find (aff, pose (I, Eigen::Vector3d::Zero ()), rom, pose (I, affT), found));
+
+  // both objects moved together: same relative pose, the region moves with the rom
+  const Eigen::Matrix3d R (Eigen::AngleAxisd (.8, Eigen::Vector3d (1., -2., .5).normalized ())
+          .toRotationMatrix ());
+  const Eigen::Vector3d T (1., 2., -.5);
+  BOOST_CHECK (cache.find (rom, pose (R, T), aff, pose (R, R * affT + T), found));
+  Points_t moved (region);
+  for (std::size_t i = 0; i < moved.size (); ++i) {
+      moved[i] = R * moved[i] + T;
+  }
+  BOOST_CHECK (sameRegion (found, moved, 1e-12));
+}
+
+BOOST_AUTO_TEST_CASE (lru_eviction)
+{
+  // one shard holding two regions
+  ResultCache cache (2, 1e-2, 1e-2, 1);
+  const BVHModelOBConst_Ptr_t rom (model ()), a (model ()), b (model ()), c (model ());
+  const fcl::Transform3f origin (pose (Eigen::Matrix3d::Identity (), Eigen::Vector3d::Zero ()));
+  Points_t found;
+  cache.insert (rom, origin, a, origin, square (1.));
+  cache.insert (rom, origin, b, origin, square (2.));
+  // a becomes the most recently used: b is evicted by c
+  BOOST_CHECK (cache.find (rom, origin, a, origin, found));
+  cache.insert (rom, origin, c, origin, square (3.));
+  BOOST_CHECK_EQUAL (cache.size (), 2u);
+  BOOST_CHECK (!cache.find (rom, origin, b, origin, found));
+  BOOST_CHECK (cache.find (rom, origin, c, origin, found));
+  BOOST_CHECK (sameRegion (found, square (3.), 0.));
+  BOOST_CHECK (cache.find (rom, origin, a, origin, found));
+  BOOST_CHECK (sameRegion (found, square (1.), 0.));
+
+  // inserting a stored key replaces its region and makes it the most recently used
+  cache.insert (rom, origin, c, origin, square (4.));
+  cache.insert (rom, origin, b, origin, square (2.));
+  BOOST_CHECK (!cache.find (rom, origin, a, origin, found));
+  BOOST_CHECK (cache.find (rom, origin, c, origin, found));
+  BOOST_CHECK (sameRegion (found, square (4.), 0.));
+}
+
+BOOST_AUTO_TEST_CASE (counters)
+{
+  ResultCache cache (64, 1e-2, 1e-2, 4);
+  const BVHModelOBConst_Ptr_t rom (model ()), aff (model ());
+  const Eigen::Matrix3d I (Eigen::Matrix3d::Identity ());
+  const fcl::Transform3f origin (pose (I, Eigen::Vector3d::Zero ()));
+  Points_t found;
+  for (int k = 0; k < 10; ++k) {
+      const fcl::Transform3f affPose (pose (I, Eigen::Vector3d (.1 * k, 0., 0.)));
+      cache.find (rom, origin, aff, affPose, found);
+      cache.insert (rom, origin, aff, affPose, square (1.));
+      cache.find (rom, origin, aff, affPose, found);
+      cache.find (rom, origin, aff, affPose, found);
+  }
+  BOOST_CHECK_EQUAL (cache.misses (), 10u);
+  BOOST_CHECK_EQUAL (cache.hits (), 20u);
+  BOOST_CHECK_EQUAL (cache.size (), 10u);
+  cache.clear ();
+  BOOST_CHECK_EQUAL (cache.misses (), 0u);
+  BOOST_CHECK_EQUAL (cache.hits (), 0u);
+  BOOST_CHECK_EQUAL (cache.size (), 0u);
+  BOOST_CHECK (!cache.find (rom, origin, aff, origin, found));
+  BOOST_CHECK_EQUAL (cache.misses (), 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
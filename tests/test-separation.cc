@@ -0,0 +1,175 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#define BOOST_TEST_MODULE test-separation
+#include <boost/test/unit_test.hpp>
+
+#include <hpp/intersect/cache.hh>
+#include <Eigen/Geometry>
+#include <cstdlib>
+#include <limits>
+
+using namespace hpp::intersect;
+
+// uniform random number in [-1, 1]
+double random11 ()
+{
+  return 2. * std::rand () / (double) RAND_MAX - 1.;
+}
+
+// corners of the axis aligned box centered on the origin, with half extents half
+void corners (const Eigen::Vector3d& half, Eigen::Vector3d res[8])
+{
+  for (int i = 0; i < 8; ++i) {
+      res[i] = Eigen::Vector3d ((i & 1) ? half[0] : -half[0], (i & 2) ? half[1] : -half[1],
+              (i & 4) ? half[2] : -half[2]);
+  }
+}
+
+// axis aligned box centered on the origin, with half extents half
+BVHModelOB_Ptr_t box (const Eigen::Vector3d& half)
+{
+  Eigen::Vector3d c[8];
+  corners (half, c);
+  // two triangles per face, oriented outwards
+  static const int faces[12][3] = {{0,2,1}, {1,2,3}, {4,5,6}, {5,7,6}, {0,1,4}, {1,5,4},
+      {2,6,3}, {3,6,7}, {0,4,2}, {2,4,6}, {1,3,5}, {3,7,5}};
+  BVHModelOB_Ptr_t model (new BVHModelOB ());
+  model->beginModel ();
+  for (int k = 0; k < 12; ++k) {
+      model->addTriangle (fcl::Vec3f (c[faces[k][0]]), fcl::Vec3f (c[faces[k][1]]),
+              fcl::Vec3f (c[faces[k][2]]));
+  }
+  model->endModel ();
+  return model;
+}
+
+// true if the axis aligned box of half extents romHalf and the box of half extents affHalf
+// at rotation R and translation T are disjoint: one of the face normals of the boxes or
+// the cross products of their edges separates their corners
+bool boxesSeparated (const Eigen::Vector3d& romHalf, const Eigen::Vector3d& affHalf,
+        const Eigen::Matrix3d& R, const Eigen::Vector3d& T)
+{
+  Eigen::Vector3d romCorners[8], affCorners[8];
+  corners (romHalf, romCorners);
+  corners (affHalf, affCorners);
+  for (int i = 0; i < 8; ++i) {
+      affCorners[i] = R * affCorners[i] + T;
+  }
+  std::vector<Eigen::Vector3d> axes;
+  for (int i = 0; i < 3; ++i) {
+      axes.push_back (Eigen::Vector3d::Unit (i));
+      axes.push_back (R.col (i));
+      for (int j = 0; j < 3; ++j) {
+          axes.push_back (Eigen::Vector3d::Unit (i).cross (R.col (j)));
+      }
+  }
+  for (std::size_t k = 0; k < axes.size (); ++k) {
+      if (axes[k].squaredNorm () < 1e-12) {
+          continue;
+      }
+      double romMin (std::numeric_limits<double>::max ()), romMax (-romMin);
+      double affMin (romMin), affMax (-romMin);
+      for (int i = 0; i < 8; ++i) {
+          romMin = std::min (romMin, axes[k].dot (romCorners[i]));
+          romMax = std::max (romMax, axes[k].dot (romCorners[i]));
+          affMin = std::min (affMin, axes[k].dot (affCorners[i]));
+          affMax = std::max (affMax, axes[k].dot (affCorners[i]));
+      }
+      if (affMin > romMax || romMin > affMax) {
+          return true;
+      }
+  }
+  return false;
+}
+
+Eigen::Matrix3d randomRotation ()
+{
+  return Eigen::Quaterniond (random11 (), random11 (), random11 (), random11 ())
+      .normalized ().toRotationMatrix ();
+}
+
+BOOST_AUTO_TEST_SUITE (test_separation)
+
+BOOST_AUTO_TEST_CASE (witness_lifecycle)
+{
+  const BVHModelOBConst_Ptr_t rom (box (Eigen::Vector3d (.2, .15, .1)));
+  const BVHModelOBConst_Ptr_t aff (box (Eigen::Vector3d (.1, .1, .05)));
+  MeshCache cache;
+  const fcl::Matrix3f I (Eigen::Matrix3d::Identity ());
+  // no witness yet
+  BOOST_CHECK (!cache.separated (rom, aff, I, fcl::Vec3f (1., 0., 0.)));
+  // no witness for overlapping models
+  BOOST_CHECK (!cache.findSeparation (rom, aff, I, fcl::Vec3f (.25, 0., 0.)));
+  BOOST_CHECK (!cache.separated (rom, aff, I, fcl::Vec3f (1., 0., 0.)));
+
+  BOOST_CHECK (cache.findSeparation (rom, aff, I, fcl::Vec3f (1., 0., 0.)));
+  BOOST_CHECK (cache.separated (rom, aff, I, fcl::Vec3f (1., 0., 0.)));
+  BOOST_CHECK (cache.separated (rom, aff, I, fcl::Vec3f (.4, .3, -.2)));
+  // the witness is kept for the ordered pair of models only
+  BOOST_CHECK (!cache.separated (aff, rom, I, fcl::Vec3f (1., 0., 0.)));
+  // in contact: the witness is dropped, even if the models move apart again
+  BOOST_CHECK (!cache.separated (rom, aff, I, fcl::Vec3f (.25, 0., 0.)));
+  BOOST_CHECK (!cache.separated (rom, aff, I, fcl::Vec3f (1., 0., 0.)));
+  BOOST_CHECK (cache.findSeparation (rom, aff, I, fcl::Vec3f (1., 0., 0.)));
+  cache.clear ();
+  BOOST_CHECK (!cache.separated (rom, aff, I, fcl::Vec3f (1., 0., 0.)));
+}
+
+BOOST_AUTO_TEST_CASE (rejects_separated_pairs_only)
+{
+  // the affordance comes from a random pose out of contact towards the rom along a line:
+  // the witness found at the first pose rejects poses where the boxes are disjoint, and is
+  // dropped at the first pose where they overlap
+  const Eigen::Vector3d romHalf (.2, .15, .1), affHalf (.1, .1, .05);
+  const BVHModelOBConst_Ptr_t rom (box (romHalf));
+  const BVHModelOBConst_Ptr_t aff (box (affHalf));
+  MeshCache cache;
+  std::srand (0);
+  int nRejected (0), nFound (0);
+  for (int trial = 0; trial < 200; ++trial) {
+      const Eigen::Matrix3d R (randomRotation ());
+      const Eigen::Vector3d start (Eigen::Vector3d (random11 (), random11 (), random11 ())
+              .normalized () * .6);
+      if (!cache.findSeparation (rom, aff, fcl::Matrix3f (R), fcl::Vec3f (start))) {
+          continue;
+      }
+      BOOST_REQUIRE (boxesSeparated (romHalf, affHalf, R, start));
+      ++nFound;
+      bool dropped (false);
+      for (int k = 0; k <= 50; ++k) {
+          const Eigen::Vector3d T ((1. - k / 50.) * start);
+          const bool separated (cache.separated (rom, aff, fcl::Matrix3f (R), fcl::Vec3f (T)));
+          if (separated) {
+              BOOST_CHECK (boxesSeparated (romHalf, affHalf, R, T));
+              BOOST_CHECK (!dropped);
+              ++nRejected;
+          } else {
+              dropped = true;
+          }
+      }
+      // the boxes overlap at the end of the line: the witness cannot be kept
+      BOOST_CHECK (dropped);
+      BOOST_CHECK (!cache.separated (rom, aff, fcl::Matrix3f (R), fcl::Vec3f (start)));
+  }
+  BOOST_CHECK (nFound > 150);
+  BOOST_CHECK (nRejected > nFound);
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
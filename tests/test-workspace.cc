@@ -0,0 +1,160 @@
+//
+//// Copyright (c) 2016 CNRS
+//// Authors: Anna Seppala
+////
+//// This file is part of hpp-intersect
+//// hpp-intersect is free software: you can redistribute it
+//// and/or modify it under the terms of the GNU Lesser General Public
+//// License as published by the Free Software Foundation, either version
+//// 3 of the License, or (at your option) any later version.
+////
+//// hpp-intersect is distributed in the hope that it will be
+//// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+//// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//// General Lesser Public License for more details.  You should have
+//// received a copy of the GNU Lesser General Public License along with
+//// hpp-intersect  If not, see
+//// <http://www.gnu.org/licenses/>.
+//
+//
+#define BOOST_TEST_MODULE test-workspace
+#include <boost/test/unit_test.hpp>
+
+#include <hpp/intersect/intersect.hh>
+#include <hpp/intersect/cache.hh>
+#include <hpp/intersect/workspace.hh>
+#include <hpp/fcl/collision_object.h>
+#include <cstdlib>
+#include <new>
+
+// every heap allocation of the test program goes through these operators:
+// allocations are counted while countAllocations is true
+namespace {
+  bool countAllocations = false;
+  std::size_t nAllocations = 0;
+}
+
+void* operator new (std::size_t size)
+{
+  if (countAllocations) {
+      ++nAllocations;
+  }
+  void* res = std::malloc (size == 0 ? 1 : size);
+  if (res == 0) {
+      throw std::bad_alloc ();
+  }
+  return res;
+}
+
+void* operator new[] (std::size_t size)
+{
+  return operator new (size);
+}
+
+void operator delete (void* p) throw ()
+{
+  std::free (p);
+}
+
+void operator delete[] (void* p) throw ()
+{
+  std::free (p);
+}
+
+using namespace hpp::intersect;
+
+// axis aligned box centered on the origin, with half extents half
+BVHModelOB_Ptr_t box (const fcl::Vec3f& half)
+{
+  fcl::Vec3f corners[8];
+  for (int i = 0; i < 8; ++i) {
+      corners[i] = fcl::Vec3f ((i & 1) ? half[0] : -half[0], (i & 2) ? half[1] : -half[1],
+              (i & 4) ? half[2] : -half[2]);
+  }
+  // two triangles per face, oriented outwards
+  static const int faces[12][3] = {{0,2,1}, {1,2,3}, {4,5,6}, {5,7,6}, {0,1,4}, {1,5,4},
+      {2,6,3}, {3,6,7}, {0,4,2}, {2,4,6}, {1,3,5}, {3,7,5}};
+  BVHModelOB_Ptr_t model (new BVHModelOB ());
+  model->beginModel ();
+  for (int k = 0; k < 12; ++k) {
+      model->addTriangle (corners[faces[k][0]], corners[faces[k][1]], corners[faces[k][2]]);
+  }
+  model->endModel ();
+  return model;
+}
+
+// flat grid of n x n squares of side 1 / n in the z = 0 plane, centered on the origin
+BVHModelOB_Ptr_t grid (const int n)
+{
+  BVHModelOB_Ptr_t model (new BVHModelOB ());
+  model->beginModel ();
+  for (int i = 0; i < n; ++i) {
+      for (int j = 0; j < n; ++j) {
+          const fcl::Vec3f p ((double) i / n - .5, (double) j / n - .5, 0.);
+          const fcl::Vec3f dx (1. / n, 0., 0.), dy (0., 1. / n, 0.);
+          model->addTriangle (p, p + dx, p + dx + dy);
+          model->addTriangle (p, p + dx + dy, p + dy);
+      }
+  }
+  model->endModel ();
+  return model;
+}
+
+BOOST_AUTO_TEST_SUITE (test_workspace)
+
+BOOST_AUTO_TEST_CASE (warm_query_does_not_allocate)
+{
+  fcl::CollisionObjectPtr_t rom (new fcl::CollisionObject (box (fcl::Vec3f (.2, .2, .2))));
+  fcl::CollisionObjectPtr_t affordance (new fcl::CollisionObject (grid (10)));
+  MeshCache cache;
+  IntersectionWorkspace workspace;
+  const IntersectionRequest request;
+  // poses of the rom: the first ones cross the affordance, the last one is above it
+  std::vector<fcl::Vec3f> positions;
+  positions.push_back (fcl::Vec3f (0., 0., 0.));
+  positions.push_back (fcl::Vec3f (.13, -.07, .05));
+  positions.push_back (fcl::Vec3f (-.21, .17, -.1));
+  positions.push_back (fcl::Vec3f (0., 0., 1.));
+
+  // the first pass fills the cache and grows the buffers of the workspace
+  for (std::size_t k = 0; k < positions.size (); ++k) {
+      rom->setTranslation (positions[k]);
+      rom->computeAABB ();
+      const std::vector<Eigen::Vector3d>& region =
+          getIntersectionPoints (rom, affordance, cache, workspace, request);
+      BOOST_CHECK_EQUAL (region.empty (), k + 1 == positions.size ());
+  }
+
+  std::size_t nContacts = 0;
+  nAllocations = 0;
+  countAllocations = true;
+  for (int pass = 0; pass < 10; ++pass) {
+      for (std::size_t k = 0; k < positions.size (); ++k) {
+          rom->setTranslation (positions[k]);
+          rom->computeAABB ();
+          nContacts += getIntersectionPoints (rom, affordance, cache, workspace, request).size ();
+      }
+  }
+  countAllocations = false;
+  BOOST_CHECK (nContacts > 0);
+  BOOST_CHECK_EQUAL (nAllocations, 0u);
+}
+
+BOOST_AUTO_TEST_CASE (separated_pair_does_not_allocate)
+{
+  // the bounds test rejects the pair before any mesh data is computed,
+  // even with the cache built by each uncached call
+  fcl::CollisionObjectPtr_t rom (new fcl::CollisionObject (box (fcl::Vec3f (.2, .2, .2))));
+  fcl::CollisionObjectPtr_t affordance (new fcl::CollisionObject (grid (10)));
+  rom->setTranslation (fcl::Vec3f (0., 0., 1.));
+  rom->computeAABB ();
+  const IntersectionRequest request;
+  nAllocations = 0;
+  countAllocations = true;
+  const std::size_t nPoints (getIntersectionPoints (rom, affordance, request).size ());
+  countAllocations = false;
+  BOOST_CHECK_EQUAL (nPoints, 0u);
+  BOOST_CHECK_EQUAL (nAllocations, 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END ()